@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "subnite_extras/common/parse_count.hpp"
+
+namespace subnite::bench {
+
+struct TimingStats {
+    double min = 0.0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+// sorts the samples in place
+TimingStats ComputeStats(std::vector<double>& samples);
+void PrintStats(const std::string& name, const TimingStats& stats, const std::string& unit);
+// for malformed arguments. @return the exit code
+int PrintUsage(const char* benchmarkAndArguments);
+
+// every benchmark gets the arguments after its name, and returns the exit code
+int RunReprepareBenchmark(int argc, char** argv);
+int RunPrecisionBenchmark(int argc, char** argv);
+int RunProcessBlockBenchmark(int argc, char** argv);
+int RunStateBenchmark(int argc, char** argv);
+
+} // namespace
@@ -0,0 +1,58 @@
+#include "benchmarks.h"
+#include "juce_init.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <map>
+
+using namespace subnite::bench;
+
+TimingStats subnite::bench::ComputeStats(std::vector<double>& samples) {
+    TimingStats stats;
+    if (samples.empty()) return stats;
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        return samples[static_cast<size_t>(p * static_cast<double>(samples.size() - 1))];
+    };
+
+    double sum = 0.0;
+    for (double sample : samples) sum += sample;
+
+    stats.min = samples.front();
+    stats.mean = sum / static_cast<double>(samples.size());
+    stats.p50 = percentile(0.5);
+    stats.p99 = percentile(0.99);
+    stats.max = samples.back();
+    return stats;
+}
+
+void subnite::bench::PrintStats(const std::string& name, const TimingStats& stats, const std::string& unit) {
+    std::printf("%-36s min %10.2f  mean %10.2f  p50 %10.2f  p99 %10.2f  max %10.2f  (%s)\n",
+        name.c_str(), stats.min, stats.mean, stats.p50, stats.p99, stats.max, unit.c_str());
+}
+
+int subnite::bench::PrintUsage(const char* benchmarkAndArguments) {
+    std::cerr << "usage: bench " << benchmarkAndArguments << "\n";
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    const std::map<std::string, std::function<int(int, char**)>> benchmarks {
+        { "reprepare", RunReprepareBenchmark },
+        { "precision", RunPrecisionBenchmark },
+        { "process", RunProcessBlockBenchmark },
+        { "state", RunStateBenchmark },
+    };
+
+    if (argc < 2 || !benchmarks.contains(argv[1])) {
+        std::cout << "usage: bench <benchmark> [args]\nbenchmarks:\n";
+        for (const auto& [name, run] : benchmarks) std::cout << "    " << name << "\n";
+        return 1;
+    }
+
+    subnite::dynlib::JuceInit juceInit{subnite::dynlib::MessageThreadMode::Headless}; // pure DSP, no message loop needed
+    return benchmarks.at(argv[1])(argc - 2, argv + 2);
+}
@@ -0,0 +1,84 @@
+#include "benchmarks.h"
+#include "plugin.h"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+using namespace subnite::bench;
+using namespace subnite::dynlib;
+
+namespace {
+
+template <typename FloatType>
+struct PlanarBuffer {
+    std::vector<std::vector<FloatType>> channels;
+    std::vector<const FloatType*> readPointers;
+    std::vector<FloatType*> writePointers;
+
+    PlanarBuffer(size_t numChannels, size_t numSamples) : channels(numChannels, std::vector<FloatType>(numSamples, FloatType(0.25))) {
+        for (auto& channel : channels) {
+            readPointers.push_back(channel.data());
+            writePointers.push_back(channel.data());
+        }
+    }
+};
+
+// @return nanoseconds per sample (per channel) of every block
+std::vector<double> TimeBlocks(size_t numBlocks, size_t samplesPerBlock, const std::function<void()>& processBlock) {
+    std::vector<double> times;
+    times.reserve(numBlocks);
+    for (size_t i = 0; i < numBlocks; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        processBlock();
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        times.push_back(elapsed / static_cast<double>(samplesPerBlock));
+    }
+    return times;
+}
+
+} // namespace
+
+// usage: bench precision [blocks per size]
+int subnite::bench::RunPrecisionBenchmark(int argc, char** argv) {
+    const auto numBlocks = subnite::ParseCountArgument(argc, argv, 0, 2000);
+    if (!numBlocks) return PrintUsage("precision [blocks per size]");
+    const size_t numChannels = 2;
+    const size_t blockSizes[] = { 64, 256, 1024, 4096 };
+
+    for (size_t blockSize : blockSizes) {
+        Plugin plugin{};
+        plugin.Prepare(48000.0, blockSize, numChannels, numChannels);
+
+        PlanarBuffer<float> floatBuffer{numChannels, blockSize};
+        PlanarBuffer<double> doubleBuffer{numChannels, blockSize};
+
+        auto floatTimes = TimeBlocks(*numBlocks, blockSize * numChannels, [&] {
+            plugin.Process(floatBuffer.readPointers.data(), floatBuffer.writePointers.data(), blockSize, numChannels);
+        });
+
+        auto doubleTimes = TimeBlocks(*numBlocks, blockSize * numChannels, [&] {
+            plugin.Process(doubleBuffer.readPointers.data(), doubleBuffer.writePointers.data(), blockSize, numChannels);
+        });
+
+        // what a 64 bit host had to do before: convert down, process in float, convert back up
+        auto convertedTimes = TimeBlocks(*numBlocks, blockSize * numChannels, [&] {
+            for (size_t channel = 0; channel < numChannels; ++channel)
+                for (size_t i = 0; i < blockSize; ++i)
+                    floatBuffer.channels[channel][i] = static_cast<float>(doubleBuffer.channels[channel][i]);
+
+            plugin.Process(floatBuffer.readPointers.data(), floatBuffer.writePointers.data(), blockSize, numChannels);
+
+            for (size_t channel = 0; channel < numChannels; ++channel)
+                for (size_t i = 0; i < blockSize; ++i)
+                    doubleBuffer.channels[channel][i] = static_cast<double>(floatBuffer.channels[channel][i]);
+        });
+
+        std::printf("block size %zu\n", blockSize);
+        PrintStats("  float", ComputeStats(floatTimes), "ns/sample");
+        PrintStats("  double", ComputeStats(doubleTimes), "ns/sample");
+        PrintStats("  double via float conversion", ComputeStats(convertedTimes), "ns/sample");
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include "benchmarks.h"
+#include "DSP/PluginProcessor.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace subnite::bench;
+
+namespace {
+
+struct ProcessResult {
+    double sampleRate = 0.0;
+    size_t numChannels = 0;
+    size_t blockSize = 0;
+    TimingStats blockMicroseconds{};
+    double nsPerSample = 0.0; // mean, per channel
+    double cpuPercent = 0.0; // mean block time relative to the block's duration
+    double cpuPercentP99 = 0.0;
+};
+
+template <typename FloatType>
+ProcessResult MeasureProcessBlock(MyPluginProcessor& processor, double sampleRate, size_t numChannels, size_t blockSize, size_t numBlocks) {
+    processor.prepareToPlayFull(sampleRate, blockSize, numChannels, numChannels);
+
+    juce::AudioBuffer<FloatType> buffer{static_cast<int>(numChannels), static_cast<int>(blockSize)};
+    juce::MidiBuffer midi{};
+    juce::Random random{1234}; // same input every run, so runs are comparable
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            buffer.setSample(channel, i, static_cast<FloatType>(random.nextFloat() * 2.f - 1.f));
+
+    // warm up the caches and the branch predictor
+    for (size_t i = 0; i < numBlocks / 10 + 1; ++i) processor.processBlock(buffer, midi);
+
+    std::vector<double> times;
+    times.reserve(numBlocks);
+    for (size_t i = 0; i < numBlocks; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        processor.processBlock(buffer, midi);
+        times.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    ProcessResult result{ .sampleRate = sampleRate, .numChannels = numChannels, .blockSize = blockSize };
+    result.blockMicroseconds = ComputeStats(times);
+
+    const double blockDurationMicroseconds = static_cast<double>(blockSize) / sampleRate * 1e6;
+    result.nsPerSample = result.blockMicroseconds.mean * 1e3 / static_cast<double>(blockSize * numChannels);
+    result.cpuPercent = result.blockMicroseconds.mean / blockDurationMicroseconds * 100.0;
+    result.cpuPercentP99 = result.blockMicroseconds.p99 / blockDurationMicroseconds * 100.0;
+    return result;
+}
+
+void WriteJson(std::ostream& out, const std::vector<ProcessResult>& results, size_t numBlocks, const char* precision, size_t numWorkers) {
+    out << "{\n  \"benchmark\": \"processBlock\",\n  \"precision\": \"" << precision << "\",\n  \"blocksPerSetting\": " << numBlocks
+        << ",\n  \"channelWorkers\": " << numWorkers << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    { \"sampleRate\": " << r.sampleRate
+            << ", \"channels\": " << r.numChannels
+            << ", \"blockSize\": " << r.blockSize
+            << ", \"nsPerSample\": " << r.nsPerSample
+            << ", \"cpuPercent\": " << r.cpuPercent
+            << ", \"cpuPercentP99\": " << r.cpuPercentP99
+            << ", \"blockUs\": { \"min\": " << r.blockMicroseconds.min
+            << ", \"mean\": " << r.blockMicroseconds.mean
+            << ", \"p50\": " << r.blockMicroseconds.p50
+            << ", \"p99\": " << r.blockMicroseconds.p99
+            << ", \"max\": " << r.blockMicroseconds.max << " } }"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+} // namespace
+
+// usage: bench process [blocks per setting] [float|double] [output.json|-] [channel workers]
+// Without an output file (or with -) the JSON goes to stdout, so two runs can be diffed.
+int subnite::bench::RunProcessBlockBenchmark(int argc, char** argv) {
+    const auto numBlocks = subnite::ParseCountArgument(argc, argv, 0, 1000);
+    const std::string precision = argc > 1 ? argv[1] : "float";
+    const bool writeToFile = argc > 2 && std::string{argv[2]} != "-";
+    const auto numWorkers = subnite::ParseCountArgument(argc, argv, 3, 0, 0);
+    if (!numBlocks || !numWorkers) return PrintUsage("process [blocks per setting] [float|double] [output.json|-] [channel workers]");
+    const double sampleRates[] = { 44100.0, 48000.0, 96000.0 };
+    const size_t channelCounts[] = { 1, 2, 6, 12, 16 }; // mono, stereo, 5.1, 7.1.4, 3rd order ambisonics
+    const size_t blockSizes[] = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+
+    if (precision != "float" && precision != "double") {
+        std::cerr << "precision has to be float or double\n";
+        return 1;
+    }
+
+    MyPluginProcessor processor{};
+    processor.setChannelWorkers(*numWorkers);
+    std::vector<ProcessResult> results;
+    for (double sampleRate : sampleRates) {
+        for (size_t numChannels : channelCounts) {
+            for (size_t blockSize : blockSizes) {
+                results.push_back(precision == "float"
+                    ? MeasureProcessBlock<float>(processor, sampleRate, numChannels, blockSize, *numBlocks)
+                    : MeasureProcessBlock<double>(processor, sampleRate, numChannels, blockSize, *numBlocks));
+            }
+        }
+    }
+
+    if (writeToFile) {
+        std::ofstream file{argv[2]};
+        if (!file) {
+            std::cerr << "couldn't open " << argv[2] << "\n";
+            return 1;
+        }
+        WriteJson(file, results, *numBlocks, precision.c_str(), *numWorkers);
+        return 0;
+    }
+    WriteJson(std::cout, results, *numBlocks, precision.c_str(), *numWorkers);
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "benchmarks.h"
+#include "plugin.h"
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+using namespace subnite::bench;
+using namespace subnite::dynlib;
+
+namespace {
+
+// @return microseconds per call
+std::vector<double> TimeCalls(size_t iterations, const std::function<void(size_t)>& call) {
+    std::vector<double> times;
+    times.reserve(iterations);
+    for (size_t i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        call(i);
+        times.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    return times;
+}
+
+} // namespace
+
+// usage: bench reprepare [iterations]
+int subnite::bench::RunReprepareBenchmark(int argc, char** argv) {
+    const auto iterations = subnite::ParseCountArgument(argc, argv, 0, 200);
+    if (!iterations) return PrintUsage("reprepare [iterations]");
+    const size_t maxBufferSize = 4096;
+    const double sampleRates[] = { 44100.0, 48000.0, 96000.0 };
+    const size_t bufferSizes[] = { 64, 256, 1024 };
+
+    // the old behaviour: a new processor for every prepare
+    auto firstPrepare = TimeCalls(*iterations, [&](size_t) {
+        Plugin plugin{};
+        plugin.Prepare(48000.0, 512, 2, 2, maxBufferSize);
+    });
+
+    Plugin plugin{};
+    plugin.Prepare(48000.0, 512, 2, 2, maxBufferSize);
+
+    auto sameSettings = TimeCalls(*iterations, [&](size_t) {
+        plugin.Prepare(48000.0, 512, 2, 2, maxBufferSize);
+    });
+    auto sampleRateChange = TimeCalls(*iterations, [&](size_t i) {
+        plugin.Prepare(sampleRates[i % 3], 512, 2, 2, maxBufferSize);
+    });
+    auto bufferSizeChange = TimeCalls(*iterations, [&](size_t i) {
+        plugin.Prepare(48000.0, bufferSizes[i % 3], 2, 2, maxBufferSize);
+    });
+    auto channelChange = TimeCalls(*iterations, [&](size_t i) {
+        size_t channels = 1 + i % 2;
+        plugin.Prepare(48000.0, 512, channels, channels, maxBufferSize);
+    });
+
+    PrintStats("construct + prepare", ComputeStats(firstPrepare), "us");
+    PrintStats("re-prepare, same settings", ComputeStats(sameSettings), "us");
+    PrintStats("re-prepare, sample rate change", ComputeStats(sampleRateChange), "us");
+    PrintStats("re-prepare, buffer size change", ComputeStats(bufferSizeChange), "us");
+    PrintStats("re-prepare, channel change", ComputeStats(channelChange), "us");
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "benchmarks.h"
+#include "Commons/PluginValueTree.h"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+using namespace subnite::bench;
+
+namespace {
+
+// the default tree plus numSliders slider trees, like subnite::Slider::updateValueTree makes them
+void AddSliders(myplugin::vt::ValueTree& tree, size_t numSliders) {
+    for (size_t i = 0; i < numSliders; ++i) {
+        juce::ValueTree slider{juce::Identifier{"Slider" + juce::String(static_cast<int>(i))}};
+        slider.setProperty("rawNormalizedValue", 0.001 * static_cast<double>(i), nullptr);
+        slider.setProperty("minValue", 0.0, nullptr);
+        slider.setProperty("maxValue", 1.0, nullptr);
+        slider.setProperty("displayValue", 0.001 * static_cast<double>(i), nullptr);
+        tree.SetChild(slider.getType(), slider);
+    }
+}
+
+// @return microseconds per call
+std::vector<double> TimeCalls(size_t iterations, const std::function<void()>& call) {
+    std::vector<double> times;
+    times.reserve(iterations);
+    for (size_t i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        call();
+        times.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    return times;
+}
+
+} // namespace
+
+// usage: bench state [sliders] [iterations]
+int subnite::bench::RunStateBenchmark(int argc, char** argv) {
+    const auto numSliders = subnite::ParseCountArgument(argc, argv, 0, 200, 0);
+    const auto iterations = subnite::ParseCountArgument(argc, argv, 1, 200);
+    if (!numSliders || !iterations) return PrintUsage("state [sliders] [iterations]");
+
+    myplugin::vt::ValueTree tree{};
+    tree.Create();
+    AddSliders(tree, *numSliders);
+
+    struct Format { const char* name; std::function<void(juce::OutputStream&)> write; };
+    const Format formats[] = {
+        { "juce", [&](juce::OutputStream& stream) { tree.WriteToStream(stream); } },
+        { "snapshot", [&](juce::OutputStream& stream) { tree.WriteCompactToStream(stream, false); } },
+        { "snapshot + zlib", [&](juce::OutputStream& stream) { tree.WriteCompactToStream(stream, true); } },
+    };
+
+    std::printf("%zu sliders\n", *numSliders);
+    for (const auto& format : formats) {
+        juce::MemoryBlock state;
+        auto save = TimeCalls(*iterations, [&] {
+            state.reset();
+            juce::MemoryOutputStream stream{state, false};
+            format.write(stream);
+        });
+
+        myplugin::vt::ValueTree restored{};
+        bool succeeded = true;
+        auto load = TimeCalls(*iterations, [&] {
+            succeeded &= restored.CopyFrom(state.getData(), static_cast<int>(state.getSize()));
+        });
+        if (!succeeded || !restored.GetRoot().isEquivalentTo(tree.GetRoot())) {
+            std::printf("%s: restored tree doesn't match\n", format.name);
+            return 1;
+        }
+
+        std::printf("%-16s %8zu bytes\n", format.name, state.getSize());
+        PrintStats(std::string(format.name) + " save", ComputeStats(save), "us");
+        PrintStats(std::string(format.name) + " load", ComputeStats(load), "us");
+    }
+    return 0;
+}
@@ -2,13 +2,18 @@
 
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <juce_events/juce_events.h>
+#include <future>
+#include <mutex>
+#include <optional>
 
 using namespace subnite::dynlib;
 
+// stands in for the message manager lock when there is no message manager
+static std::mutex headlessMutex;
+
 struct MessageManagerLock::Impl {
-    Impl() : lock() {}
-    ~Impl() = default;
-    juce::MessageManagerLock lock;
+    std::unique_lock<std::mutex> headlessLock;
+    std::optional<juce::MessageManagerLock> lock;
 };
 
 extern "C" {
@@ -17,26 +22,60 @@ MessageManagerLock::MessageManagerLock()
 : lockWasGained(false)
 {
     impl = std::make_shared<Impl>();
-    lockWasGained = impl->lock.lockWasGained();
+
+    // decided per lock and not per JuceInit, another part of the process may run a message thread while this one is headless
+    if (juce::MessageManager::getInstanceWithoutCreating() == nullptr) {
+        impl->headlessLock = std::unique_lock<std::mutex>{headlessMutex};
+        lockWasGained = true;
+        return;
+    }
+
+    impl->lock.emplace();
+    lockWasGained = impl->lock->lockWasGained();
 }
 
-JuceInit::JuceInit() {
+JuceInit::JuceInit(MessageThreadMode threadMode)
+: mode(threadMode)
+{
+    if (mode == MessageThreadMode::Headless) {
+        shouldRunMessageThread = false;
+        return;
+    }
+
     shouldRunMessageThread = true;
+    std::promise<void> messageThreadReady;
+
     // start the message thread
-    messageThread = std::thread([this] {
+    messageThread = std::thread([this, &messageThreadReady] {
         juce::MessageManager* juceManager = juce::MessageManager::getInstance();
         juceManager->setCurrentThreadAsMessageThread();
         juce::ScopedJuceInitialiser_GUI juceInit{}; // has to be on the message thread apparently
+        messageThreadReady.set_value(); // the destructor can reach the message manager from here on
+
+        if (mode == MessageThreadMode::EventDriven) {
+            juceManager->runDispatchLoop(); // blocks until stopDispatchLoop
+            return;
+        }
+
         while (this->shouldRunMessageThread.load())
         {
             juceManager->runDispatchLoopUntil(10);                     // timeout in ms
             std::this_thread::sleep_for(std::chrono::milliseconds(1)); // keep CPU sane
         }
     });
+
+    messageThreadReady.get_future().wait();
 }
 
 JuceInit::~JuceInit() {
+    if (mode == MessageThreadMode::Headless) return;
+
     shouldRunMessageThread = false;
+    if (mode == MessageThreadMode::EventDriven) {
+        if (auto* juceManager = juce::MessageManager::getInstanceWithoutCreating())
+            juceManager->stopDispatchLoop(); // posts a quit message, which wakes the loop up
+    }
+
     if (messageThread.joinable())
         messageThread.join();
 }
@@ -1,54 +1,37 @@
 #include "parameter_t.h"
+#include <algorithm>
 
 using namespace subnite::dynlib;
 
-void Parameter::Set(float rangedValue) {
-    if (rangedValue > this->max) rangedValue = this->max;
-    else if (rangedValue < this->min) rangedValue = this->min;
-
-    bool wasChanged = SetIfChanged(this->value, rangedValue);
-    if (wasChanged) ValueChangedCallback(rangedValue);
-}
-
-void Parameter::SetNormalized(float normalizedValue) {
-    // clamp normalized
-    if (normalizedValue < 0.f) normalizedValue = 0.f;
-    else if (normalizedValue > 1.f) normalizedValue = 1.f;
-
-    float val = NormalizedToRanged(normalizedValue);
-    bool wasChanged = SetIfChanged(this->value, val);
-    if (wasChanged) ValueChangedCallback(val);
+// the ranges of all parameters, indexed by PluginParameter
+static constexpr std::array<ParameterRange, ParameterBank::count> parameterRanges {{
+    /* Power */ { 0.f, 1.f, 0.f },
+}};
+
+ParameterBank::ParameterBank() {
+    for (size_t p = 0; p < count; ++p) {
+        min[p] = parameterRanges[p].min;
+        max[p] = parameterRanges[p].max;
+        value[p] = parameterRanges[p].defaultValue;
+    }
 }
 
-float Parameter::Get() const {
-    return this->value;
+void ParameterBank::Set(PluginParameter parameter, float rangedValue) {
+    const size_t p = static_cast<size_t>(parameter);
+    value[p] = std::clamp(rangedValue, min[p], max[p]);
 }
 
-float Parameter::GetNormalized() const {
-    return RangedToNormalized(this->value);
+void ParameterBank::SetNormalized(PluginParameter parameter, float normalizedValue) {
+    const size_t p = static_cast<size_t>(parameter);
+    normalizedValue = std::clamp(normalizedValue, 0.f, 1.f);
+    Set(parameter, normalizedValue * (max[p] - min[p]) + min[p]);
 }
 
-Parameter::Parameter(float min, float max, float defaultValue)
-: min(min), max(max), value(defaultValue)
-{}
-
-float Parameter::NormalizedToRanged(float normalized) const {
-    normalized *= (max-min);
-    normalized += min;
-    return normalized;
-}
-
-float Parameter::RangedToNormalized(float ranged) const {
-    ranged -= min;
-    ranged /= (max-min);
-    return ranged;
+float ParameterBank::Get(PluginParameter parameter) const {
+    return value[static_cast<size_t>(parameter)];
 }
 
-void Parameter::ValueChangedCallback(const float& newRangedValue)
-{}
-
-bool Parameter::SetIfChanged(float& dest, float value) {
-    bool differs = dest != value;
-    if (differs) dest = value;
-    return differs;
+float ParameterBank::GetNormalized(PluginParameter parameter) const {
+    const size_t p = static_cast<size_t>(parameter);
+    return (value[p] - min[p]) / (max[p] - min[p]);
 }
@@ -1,36 +1,35 @@
 #pragma once
 #include "common.h"
-#include <string>
-#include <memory>
-#include "observer_t.h"
+#include "plugin.h"
+#include <array>
 
 namespace subnite::dynlib
 {
 
-class Parameter {
+struct ParameterRange {
+    float min;
+    float max;
+    float defaultValue;
+};
+
+// All parameters in flat, PluginParameter::Count sized arrays (structure of arrays).
+// Only the control thread uses it, for GetState. The processor gets every change as an event and ramps them in its ParameterSmoother.
+// Values are ranged unless the function says otherwise.
+class ParameterBank {
 public:
-    Parameter() = delete;
-    Parameter(float min, float max, float defaultValue);
-    void Set(float rangedValue);
-    void SetNormalized(float normalizedValue);
-    float Get() const;
-    float GetNormalized() const;
+    static constexpr size_t count = static_cast<size_t>(PluginParameter::Count);
 
-protected:
-    const float min;
-    const float max;
+    ParameterBank();
 
-    // defaults to a linear remap
-    virtual float NormalizedToRanged(float normalized) const;
-    // defaults to a linear remap
-    virtual float RangedToNormalized(float ranged) const;
-    // called when the value has succesfully changed
-    virtual void ValueChangedCallback(const float &newRangedValue);
-    // decides if the value has changed, and then updates it.
-    virtual bool SetIfChanged(float &dest, float value);
+    void Set(PluginParameter parameter, float rangedValue);
+    void SetNormalized(PluginParameter parameter, float normalizedValue);
+    float Get(PluginParameter parameter) const;
+    float GetNormalized(PluginParameter parameter) const;
 
 private:
-    float value;
+    alignas(64) std::array<float, count> min{};
+    alignas(64) std::array<float, count> max{};
+    alignas(64) std::array<float, count> value{};
 };
 
 } // namespace
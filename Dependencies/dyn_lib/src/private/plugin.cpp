@@ -3,24 +3,86 @@
 #include "juce_audio_processors/juce_audio_processors.h"
 #include "juce_core/juce_core.h"
 #include "DSP/PluginProcessor.h"
-#include <unordered_map>
+#include <array>
 #include "parameter_t.h"
 #include "observer_t.h"
 #include "juce_init.h"
+#include <limits>
 
 using namespace subnite::dynlib;
 
+// which value tree property every PluginParameter drives in the processor, indexed by PluginParameter
+static constexpr std::array<myplugin::vt::Property, ParameterBank::count> parameterProperties {{
+    /* Power */ myplugin::vt::Property::P_POWER,
+}};
+
 struct Plugin::Impl {
     std::shared_ptr<Observer<MyPluginProcessor>> dsp;
     juce::MidiBuffer midi{}; // empty
-    std::unordered_map<PluginParameter, std::unique_ptr<Parameter>> params;
+    ParameterBank params{}; // control thread, what GetState returns. The processor has its own copy of every value.
+    std::array<bool, ParameterBank::count> unsentParams{}; // set before the processor existed
+    juce::AudioBuffer<float> planarScratch{}; // sized in Prepare, used by the interleaved Process
+    size_t maxBufferSize = 0; // what everything was preallocated for
+    size_t preparedBufferSize = 0; // longer blocks are split into chunks of this size
+    size_t preparedChannels = 0; // max of the in and out channels, any layout up to myplugin::layouts::maxChannels
+
     Impl() {
         dsp = std::make_shared<Observer<MyPluginProcessor>>();
-
-        // fill in params
-        params[PluginParameter::Power] = std::make_unique<Parameter>(0.f, 1.f, 0.f);
     }
     ~Impl() = default;
+
+    // control thread. The processor's EventDispatcher splits its blocks at the offset, so the change lands on its sample.
+    bool SendParameter(PluginParameter parameter, float value, size_t sampleOffset) {
+        return dsp->obj->pushParameterChange({
+            .parameter = parameterProperties[static_cast<size_t>(parameter)],
+            .value = value,
+            .sampleOffset = static_cast<int>(std::min<size_t>(sampleOffset, std::numeric_limits<int>::max())),
+        });
+    }
+
+    // with the tree to ourselves (message thread or MessageManagerLock). Only flushes when there's something to flush,
+    // so with no pending parameter changes this writes straight from the tree without allocating.
+    bool WriteSnapshot(void* dest, size_t capacity, size_t& bytesWritten) {
+        auto& processor = *dsp->obj;
+        if (processor.hasPendingParameterChanges()) processor.flushParameterChanges();
+        return processor.vTree.WriteSnapshot(dest, capacity, bytesWritten);
+    }
+
+    // processes the block in chunks of the prepared size. Parameter offsets count on across the chunks, the processor carries them over.
+    template <typename FloatType>
+    void ProcessChunked(FloatType* const* channels, size_t numChannels, size_t bufferSize) {
+        for (size_t position = 0; position < bufferSize; position += preparedBufferSize) {
+            const size_t length = std::min(preparedBufferSize, bufferSize - position);
+
+            // refers to the channels, doesn't copy them
+            juce::AudioBuffer<FloatType> chunk{channels, static_cast<int>(numChannels), static_cast<int>(position), static_cast<int>(length)};
+            dsp->obj->processBlock(chunk, midi);
+        }
+    }
+
+    // the planar Process, for both precisions
+    template <typename FloatType>
+    PluginResult ProcessPlanar(const FloatType** inputBuffer, FloatType** outputBuffer, size_t bufferSize, size_t numChannels, bool wasPrepared) {
+        if (numChannels == 0) return PluginResult::FailedToProcess;
+        if (inputBuffer == nullptr || outputBuffer == nullptr) return PluginResult::FailedToProcess;
+        for (size_t channel = 0; channel < numChannels; ++channel) {
+            if (inputBuffer[channel] == nullptr || outputBuffer[channel] == nullptr) return PluginResult::FailedToProcess;
+        }
+
+        if (!wasPrepared) return PluginResult::NotPrepared; // preparing here would construct the processor on the audio thread
+        if (numChannels > preparedChannels) return PluginResult::FailedToProcess; // prepare with more channels instead
+        midi.clear();
+
+        // copy input to output buffer, unless the caller wants it processed in place
+        for (size_t channel = 0; channel < numChannels; ++channel) {
+            if (inputBuffer[channel] != outputBuffer[channel])
+                std::memcpy(outputBuffer[channel], inputBuffer[channel], bufferSize * sizeof(FloatType));
+        }
+
+        ProcessChunked(outputBuffer, numChannels, bufferSize);
+
+        return PluginResult::Success;
+    }
 };
 
 extern "C" {
@@ -40,9 +102,22 @@ Plugin::~Plugin() {
 
 PluginResult Plugin::SetParameter(const PluginParameter &parameterType, float newValue)
 {
-    impl->params[parameterType]->Set(newValue);
-    // TODO: this doesn't update the PluginState state variable.
+    return PushParameterEvent(parameterType, newValue, 0);
+}
+
+PluginResult Plugin::PushParameterEvent(const PluginParameter &parameterType, float newValue, size_t sampleOffset)
+{
+    if (parameterType >= PluginParameter::Count) return PluginResult::ParameterDoesntExist;
+
+    // no processor yet, Prepare sends it once there is one
+    if (!impl->dsp->obj) {
+        impl->params.Set(parameterType, newValue);
+        impl->unsentParams[static_cast<size_t>(parameterType)] = true;
+        return PluginResult::Success;
+    }
 
+    if (!impl->SendParameter(parameterType, newValue, sampleOffset)) return PluginResult::ParameterQueueFull;
+    impl->params.Set(parameterType, newValue);
     return PluginResult::Success;
 }
 
@@ -62,25 +137,52 @@ PluginResult Plugin::SetState(const PluginState &state) {
 }
 
 PluginResult Plugin::Process(const float** inputBuffer, float** outputBuffer, const size_t& bufferSize, const size_t& numChannels) {
-    if (numChannels == 0 || numChannels > 2) return PluginResult::FailedToProcess;
-    if (inputBuffer == nullptr || outputBuffer == nullptr) return PluginResult::FailedToProcess;
-    for (size_t channel = 0; channel < numChannels; ++channel) {
-        if (inputBuffer[channel] == nullptr || outputBuffer[channel] == nullptr) return PluginResult::FailedToProcess;
-    }
+    if (!impl) return PluginResult::FailedToProcess;
+    return impl->ProcessPlanar(inputBuffer, outputBuffer, bufferSize, numChannels, wasPrepared);
+}
 
-    if (!wasPrepared) {
-        Prepare(48000.0, bufferSize, numChannels, numChannels);
-    }
+PluginResult Plugin::Process(const double** inputBuffer, double** outputBuffer, const size_t& bufferSize, const size_t& numChannels) {
+    if (!impl) return PluginResult::FailedToProcess;
+    return impl->ProcessPlanar(inputBuffer, outputBuffer, bufferSize, numChannels, wasPrepared);
+}
+
+PluginResult Plugin::Process(const float* interleavedInput, float* interleavedOutput, const size_t& bufferSize, const size_t& numChannels) {
+    if (numChannels == 0) return PluginResult::FailedToProcess;
+    if (interleavedInput == nullptr || interleavedOutput == nullptr) return PluginResult::FailedToProcess;
 
     if (!impl) return PluginResult::FailedToProcess;
+    if (!wasPrepared) return PluginResult::NotPrepared; // preparing here would construct the processor on the audio thread
+    auto& scratch = impl->planarScratch;
+    if (numChannels > static_cast<size_t>(scratch.getNumChannels()))
+        return PluginResult::FailedToProcess; // never allocate here, prepare with more channels instead
+
     impl->midi.clear();
 
-    // copy input to output buffer
-    for (size_t channel = 0; channel < numChannels; ++channel)
-        std::memcpy(outputBuffer[channel], inputBuffer[channel], bufferSize * sizeof(float));
+    // longer buffers go through the scratch in chunks
+    const size_t chunkSize = static_cast<size_t>(scratch.getNumSamples());
+    for (size_t chunkStart = 0; chunkStart < bufferSize; chunkStart += chunkSize) {
+        const size_t numFrames = std::min(chunkSize, bufferSize - chunkStart);
+        const float* chunkInput = interleavedInput + chunkStart * numChannels;
+        float* chunkOutput = interleavedOutput + chunkStart * numChannels;
+
+        // de-interleave straight into the planar scratch
+        for (size_t channel = 0; channel < numChannels; ++channel) {
+            float* dest = scratch.getWritePointer(static_cast<int>(channel));
+            const float* src = chunkInput + channel;
+            for (size_t frame = 0; frame < numFrames; ++frame)
+                dest[frame] = src[frame * numChannels];
+        }
 
-    juce::AudioBuffer<float> buf{outputBuffer, static_cast<int>(numChannels), static_cast<int>(bufferSize)};
-    this->impl->dsp->obj->processBlock(buf, this->impl->midi);
+        impl->ProcessChunked(scratch.getArrayOfWritePointers(), numChannels, numFrames);
+
+        // and interleave it back
+        for (size_t channel = 0; channel < numChannels; ++channel) {
+            const float* src = scratch.getReadPointer(static_cast<int>(channel));
+            float* dest = chunkOutput + channel;
+            for (size_t frame = 0; frame < numFrames; ++frame)
+                dest[frame * numChannels] = src[frame];
+        }
+    }
 
     return PluginResult::Success;
 }
@@ -95,17 +197,73 @@ PluginResult Plugin::GetState(PluginState & stateToOverwrite) {
     return PluginResult::Success;
 }
 
-PluginResult Plugin::Prepare(double sampleRate, size_t bufferSize, size_t inChannels, size_t outChannels) {
-    // if (dsp) dsp.reset();
+PluginResult Plugin::GetLoadStats(PluginLoadStats& stats) const {
+    static_assert(PluginLoadStats::numBins == subnite::LoadMeter::numBins);
+    if (!impl || !impl->dsp->obj) return PluginResult::NotPrepared;
+
+    auto meterStats = impl->dsp->obj->loadMeter.GetStats();
+    stats.numBlocks = meterStats.numBlocks;
+    stats.numOverruns = meterStats.numOverruns;
+    stats.averageLoad = meterStats.averageLoad;
+    stats.peakLoad = meterStats.peakLoad;
+    std::copy(meterStats.histogram.begin(), meterStats.histogram.end(), stats.histogram);
+    return PluginResult::Success;
+}
+
+PluginResult Plugin::GetStateSnapshot(void* dest, size_t capacity, size_t& bytesWritten) {
+    bytesWritten = 0;
+    if (!impl || !impl->dsp->obj) return PluginResult::FailedToReturnState; // prepare first
+
+    // the tree belongs to the message thread, anywhere else it takes the lock (which allocates and waits for the message thread)
+    bool fits = false;
+    if (juce::MessageManager::existsAndIsCurrentThread()) {
+        fits = impl->WriteSnapshot(dest, capacity, bytesWritten);
+    } else {
+        subnite::dynlib::MessageManagerLock lock{};
+        if (!lock.lockWasGained) return PluginResult::FailedToReturnState;
+        fits = impl->WriteSnapshot(dest, capacity, bytesWritten);
+    }
+    return fits ? PluginResult::Success : PluginResult::FailedToReturnState;
+}
+
+PluginResult Plugin::SetStateSnapshot(const void* data, size_t sizeInBytes) {
+    if (!impl || !impl->dsp->obj) return PluginResult::FailedToSetState; // prepare first
+
     subnite::dynlib::MessageManagerLock lock{};
-    impl->dsp->obj = std::make_unique<MyPluginProcessor>();
-    impl->dsp->obj->prepareToPlayFull(sampleRate, bufferSize, inChannels, outChannels);
+    if (!lock.lockWasGained) return PluginResult::FailedToSetState;
+    bool restored = impl->dsp->obj->vTree.ReadSnapshot(data, sizeInBytes);
+    return restored ? PluginResult::Success : PluginResult::FailedToSetState;
+}
+
+PluginResult Plugin::Prepare(double sampleRate, size_t bufferSize, size_t inChannels, size_t outChannels, size_t maxBufferSize) {
+    if (!impl || sampleRate <= 0.0 || bufferSize == 0) return PluginResult::FailedToPrepare;
+    if (std::max(inChannels, outChannels) > myplugin::layouts::maxChannels) return PluginResult::FailedToPrepare;
+    maxBufferSize = std::max(bufferSize, maxBufferSize);
+
+    // only constructing needs the message thread, after that the processor is re-prepared in place
+    if (!impl->dsp->obj) {
+        subnite::dynlib::MessageManagerLock lock{};
+        impl->dsp->obj = std::make_unique<MyPluginProcessor>();
+    }
+    impl->dsp->obj->prepareToPlayFull(sampleRate, bufferSize, inChannels, outChannels, maxBufferSize);
+
+    // whatever was set before the processor existed, applied at the start of the first block
+    for (size_t p = 0; p < ParameterBank::count; ++p) {
+        const auto parameter = static_cast<PluginParameter>(p);
+        if (impl->unsentParams[p] && impl->SendParameter(parameter, impl->params.Get(parameter), 0)) impl->unsentParams[p] = false;
+    }
+
+    // these keep their memory when they're already big enough
+    impl->planarScratch.setSize(static_cast<int>(std::max(inChannels, outChannels)), static_cast<int>(maxBufferSize), false, true, true);
+    impl->maxBufferSize = maxBufferSize;
+    impl->preparedBufferSize = bufferSize;
+    impl->preparedChannels = std::max(inChannels, outChannels);
     wasPrepared = true;
     return PluginResult::Success;
 }
 
 void Plugin::WriteParamsToState() {
-    state.power = impl->params[PluginParameter::Power]->Get();
+    state.power = impl->params.Get(PluginParameter::Power);
 }
 
 }
@@ -0,0 +1,142 @@
+#include "plugin_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace subnite::dynlib;
+
+struct PluginPool::Impl {
+    // the contiguous slice of jobs a participant starts on, others steal from it once they run dry
+    struct alignas(64) JobRange {
+        std::atomic<size_t> next{0};
+        size_t end = 0;
+    };
+
+    std::vector<std::thread> workers;
+    std::unique_ptr<JobRange[]> ranges; // one per worker, plus the last one for the calling thread
+    size_t numParticipants = 1;
+
+    std::mutex batchMutex; // only one ProcessBlock at a time
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    uint64_t generation = 0;
+    size_t workersLeft = 0;
+    bool shouldStop = false;
+    PluginJob* jobs = nullptr;
+
+    Impl(size_t numThreads) {
+        if (numThreads == 0) numThreads = std::max(1u, std::thread::hardware_concurrency());
+        numParticipants = numThreads;
+        ranges = std::make_unique<JobRange[]>(numParticipants);
+
+        // the caller is a participant as well, so spawn one thread less
+        for (size_t worker = 0; worker + 1 < numParticipants; ++worker)
+            workers.emplace_back([this, worker] { WorkerLoop(worker); });
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            shouldStop = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers)
+            if (worker.joinable()) worker.join();
+    }
+
+    static void RunJob(PluginJob& job) {
+        auto start = std::chrono::steady_clock::now();
+        job.result = job.plugin == nullptr
+            ? PluginResult::FailedToProcess
+            : job.plugin->Process(job.inputBuffer, job.outputBuffer, job.bufferSize, job.numChannels);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        job.processNanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    void DrainRange(JobRange& range) {
+        for (size_t index = range.next.fetch_add(1); index < range.end; index = range.next.fetch_add(1))
+            RunJob(jobs[index]);
+    }
+
+    void Participate(size_t self) {
+        DrainRange(ranges[self]);
+        // own slice is empty, steal from the others
+        for (size_t offset = 1; offset < numParticipants; ++offset)
+            DrainRange(ranges[(self + offset) % numParticipants]);
+    }
+
+    void WorkerLoop(size_t self) {
+        uint64_t seenGeneration = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock{mutex};
+                wake.wait(lock, [&] { return shouldStop || generation != seenGeneration; });
+                if (shouldStop) return;
+                seenGeneration = generation;
+            }
+
+            Participate(self);
+
+            std::lock_guard<std::mutex> lock{mutex};
+            if (--workersLeft == 0) done.notify_one();
+        }
+    }
+};
+
+extern "C" {
+
+PluginPool::PluginPool(size_t numThreads) {
+    impl = std::make_shared<Impl>(numThreads);
+}
+
+PluginPool::~PluginPool() {
+    if (impl) impl.reset(); // joins the workers
+}
+
+PluginResult PluginPool::ProcessBlock(PluginJob* jobs, size_t numJobs) {
+    if (numJobs == 0) return PluginResult::Success;
+    if (jobs == nullptr || !impl) return PluginResult::FailedToProcess;
+
+    std::lock_guard<std::mutex> batchLock{impl->batchMutex};
+    {
+        std::lock_guard<std::mutex> lock{impl->mutex};
+        impl->jobs = jobs;
+
+        // hand every participant an equal slice up front
+        const size_t participants = impl->numParticipants;
+        const size_t sliceSize = (numJobs + participants - 1) / participants;
+        for (size_t p = 0; p < participants; ++p) {
+            impl->ranges[p].next.store(std::min(numJobs, p * sliceSize));
+            impl->ranges[p].end = std::min(numJobs, (p + 1) * sliceSize);
+        }
+
+        impl->workersLeft = impl->workers.size();
+        ++impl->generation;
+    }
+    impl->wake.notify_all();
+
+    impl->Participate(impl->numParticipants - 1);
+
+    {
+        std::unique_lock<std::mutex> lock{impl->mutex};
+        impl->done.wait(lock, [this] { return impl->workersLeft == 0; });
+        impl->jobs = nullptr;
+    }
+
+    bool allSucceeded = std::all_of(jobs, jobs + numJobs, [](const PluginJob& job) {
+        return job.result == PluginResult::Success;
+    });
+    return allSucceeded ? PluginResult::Success : PluginResult::FailedToProcess;
+}
+
+size_t PluginPool::GetNumThreads() const {
+    return impl ? impl->numParticipants : 0;
+}
+
+} // extern C
@@ -7,6 +7,20 @@
 
 namespace subnite::dynlib {
 
+enum class MY_API MessageThreadMode {
+    EventDriven, // the message thread sleeps until something is posted to it
+    Polling,     // the message thread wakes up every few ms to dispatch, even when nothing is queued
+    // No message thread at all, for pure DSP use. Only this JuceInit is headless: if anything else in the process runs a
+    // message manager, MessageManagerLock still locks against it. Without one, nothing is ever dispatched, so in the processor:
+    // - editors and anything else that needs the message loop don't work
+    // - PluginParameters never flushes on its timer, the tree catches up on the parameters when the state is read
+    // - setStateInformation restores synchronously instead of on a worker
+    // - blocks that outgrow the prepared memory keep being processed in pieces of it, the bigger memory is never allocated
+    Headless
+};
+
+// Locks the message manager when there is one. Without one (headless) it locks a process wide mutex instead,
+// so code that expects to be alone on the message thread (constructing processors, ...) is still serialized.
 struct MY_API MessageManagerLock {
     MessageManagerLock();
     bool lockWasGained;
@@ -17,9 +31,11 @@ private:
 
 class MY_API JuceInit {
 public:
-    JuceInit();
+    JuceInit(MessageThreadMode mode = MessageThreadMode::EventDriven);
     ~JuceInit();
+    bool IsHeadless() const { return mode == MessageThreadMode::Headless; }
 private:
+    MessageThreadMode mode;
     std::thread messageThread;
     std::atomic<bool> shouldRunMessageThread { true };
 };
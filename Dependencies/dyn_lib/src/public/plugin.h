@@ -1,6 +1,7 @@
 #pragma once
 #include "common.h"
 #include <memory>
+#include <stdint.h>
 
 namespace subnite::dynlib {
 
@@ -10,7 +11,10 @@ enum class MY_API PluginResult {
     ParameterDoesntExist,
     ParameterTypeDoesntMatch,
     FailedToProcess,
-    FailedToReturnState
+    FailedToReturnState,
+    ParameterQueueFull,
+    NotPrepared,
+    FailedToPrepare
 };
 
 enum MY_API PluginParameter {
@@ -22,15 +26,52 @@ struct MY_API PluginState {
     float power = 1.0f;
 };
 
+// how long processing took compared to the time the audio lasts. A load of 1 is the whole budget.
+struct MY_API PluginLoadStats {
+    static constexpr size_t numBins = 32;
+    uint64_t numBlocks = 0;
+    uint64_t numOverruns = 0; // blocks that took longer than their budget
+    float averageLoad = 0.f;  // of the last 256 blocks
+    float peakLoad = 0.f;
+    uint64_t histogram[numBins] = {}; // 5% of the budget per bin, the last one holds 155% and up
+};
+
 class MY_API Plugin {
 public:
     Plugin();
     ~Plugin();
-    PluginResult SetParameter(const PluginParameter& parameterType, float newValue); // only working with floats because templates are a mess in libraries.
+    PluginResult SetParameter(const PluginParameter& parameterType, float newValue); // only working with floats because templates are a mess in libraries. Same as PushParameterEvent at offset 0.
+    // lock free and sample accurate, goes straight to the processor's event queue (MyPluginProcessor::pushParameterChange), which splits its blocks at the offset.
+    // The change lands sampleOffset samples into the next Process call (later offsets carry over to the blocks after it).
+    // Safe to call from one control thread while another thread is processing. Before Prepare the value is kept and sent once the processor exists.
+    PluginResult PushParameterEvent(const PluginParameter& parameterType, float newValue, size_t sampleOffset = 0);
     PluginResult SetState(const PluginState& state);
+    // planar buffers. When inputBuffer[ch] == outputBuffer[ch] for every channel the block is processed in place without copying.
+    // Any bufferSize works: longer buffers are processed in chunks of the prepared size, shorter ones as they are.
     PluginResult Process(const float** inputBuffer, float** outputBuffer, const size_t& bufferSize, const size_t& numChannels);
+    // same as above in 64 bit, the processor runs natively in double precision
+    PluginResult Process(const double** inputBuffer, double** outputBuffer, const size_t& bufferSize, const size_t& numChannels);
+    // interleaved frames (L R L R ...). De-interleaves into preallocated scratch, in chunks when bufferSize is bigger than it.
+    PluginResult Process(const float* interleavedInput, float* interleavedOutput, const size_t& bufferSize, const size_t& numChannels);
     PluginResult GetState(PluginState& stateToOverwrite);
-    PluginResult Prepare(double sampleRate, size_t bufferSize, size_t inChannels, size_t outChannels);
+    // lock free, safe to call from any thread while another one is processing
+    PluginResult GetLoadStats(PluginLoadStats& stats) const;
+    // Compact, versioned binary snapshot of the processor's whole value tree, written into dest.
+    // Same format as the plugin's state (getStateInformation), so each can be restored from the other.
+    // bytesWritten is set to the needed size, also when capacity was too small (FailedToReturnState), so you can size your buffer with it.
+    // Includes parameter changes the message thread hasn't written to the tree yet. Writing the snapshot never allocates, but
+    // flushing those changes into the tree can, and so does taking the MessageManagerLock when called off the message thread.
+    // Only on the message thread with no parameter changes pending is it allocation free. Never call it from the audio thread.
+    PluginResult GetStateSnapshot(void* dest, size_t capacity, size_t& bytesWritten);
+    // restores a snapshot from GetStateSnapshot or a plugin state. Only allocates when the tree layout or string values changed,
+    // or for plugin states (which carry their own identifiers and may be compressed). Takes the MessageManagerLock too.
+    PluginResult SetStateSnapshot(const void* data, size_t sizeInBytes);
+    // Has to be called before Process, and never while another thread is processing.
+    // Calling it again re-prepares the same processor in place. Buffers are preallocated for maxBufferSize (at least bufferSize),
+    // so re-preparing within that size doesn't allocate.
+    // Channel counts up to 64 work, the layout is picked from the count (6 = 5.1, 12 = 7.1.4, 16 = 3rd order ambisonics, ...).
+    // Process accepts up to max(inChannels, outChannels) channels.
+    PluginResult Prepare(double sampleRate, size_t bufferSize, size_t inChannels, size_t outChannels, size_t maxBufferSize = 0);
 private:
     void WriteParamsToState();
     PluginState state{};
@@ -0,0 +1,36 @@
+#pragma once
+#include "common.h"
+#include "plugin.h"
+#include <memory>
+#include <cstdint>
+
+namespace subnite::dynlib {
+
+// one Plugin::Process call, handed to a PluginPool
+struct MY_API PluginJob {
+    Plugin* plugin = nullptr;
+    const float** inputBuffer = nullptr;
+    float** outputBuffer = nullptr;
+    size_t bufferSize = 0;
+    size_t numChannels = 0;
+
+    // filled in by the pool after processing
+    PluginResult result = PluginResult::Success;
+    uint64_t processNanoseconds = 0;
+};
+
+// Processes many Plugin instances for one block across a work stealing thread pool.
+// Every plugin should be prepared before it is handed to the pool, and a plugin can only appear once per batch.
+class MY_API PluginPool {
+public:
+    PluginPool(size_t numThreads = 0); // 0 uses the hardware concurrency. The calling thread always helps out too.
+    ~PluginPool();
+    // returns when all jobs are done, FailedToProcess if any of them failed (check the job results)
+    PluginResult ProcessBlock(PluginJob* jobs, size_t numJobs);
+    size_t GetNumThreads() const;
+private:
+    struct Impl;
+    std::shared_ptr<Impl> impl; // hiding the implementation. Shared pointers don't need a complete type at declaration or destruction.
+};
+
+} // namespace
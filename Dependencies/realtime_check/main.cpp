@@ -0,0 +1,121 @@
+#include "plugin.h"
+#include "juce_init.h"
+#include "DSP/PluginProcessor.h"
+#include "subnite_extras/common/realtime_check.h"
+#include "subnite_extras/common/parse_count.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+
+using namespace subnite::dynlib;
+
+namespace {
+
+constexpr size_t maxReportedViolations = 8; // the rest is only counted, the same stack every block isn't useful
+
+void PrintFirstViolations(subnite::rt::ViolationType type, const char* what) {
+    static std::atomic<size_t> numPrinted{0};
+    if (numPrinted++ < maxReportedViolations) subnite::rt::PrintViolation(type, what);
+}
+
+// the block sizes a host can throw at something prepared for preparedSize
+std::vector<size_t> GetBlockSizes(size_t preparedSize) {
+    return { preparedSize, preparedSize / 2, preparedSize - 1, 13, 1 };
+}
+
+template <typename FloatType>
+size_t CheckProcessor(MyPluginProcessor& processor, size_t numChannels, size_t preparedSize, size_t iterations) {
+    juce::AudioBuffer<FloatType> buffer{static_cast<int>(numChannels), static_cast<int>(preparedSize)};
+    juce::MidiBuffer midi{};
+    juce::Random random{1234};
+    const size_t before = subnite::rt::GetNumViolations();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        for (size_t blockSize : GetBlockSizes(preparedSize)) {
+            if (blockSize == 0) continue;
+            buffer.setSize(static_cast<int>(numChannels), static_cast<int>(blockSize), false, false, true); // never reallocates, it only shrinks
+            // noise, silent input would let the processor sleep and skip everything worth checking
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+                    buffer.setSample(channel, sample, static_cast<FloatType>(random.nextFloat() * 2.f - 1.f));
+
+            subnite::rt::ScopedRealtimeSection realtime;
+            processor.processBlock(buffer, midi);
+        }
+    }
+    return subnite::rt::GetNumViolations() - before;
+}
+
+template <typename FloatType>
+size_t CheckPlugin(Plugin& plugin, size_t numChannels, size_t preparedSize, size_t iterations) {
+    std::vector<std::vector<FloatType>> channels(numChannels, std::vector<FloatType>(preparedSize * 2, FloatType(0.25)));
+    std::vector<const FloatType*> readPointers;
+    std::vector<FloatType*> writePointers;
+    for (auto& channel : channels) {
+        readPointers.push_back(channel.data());
+        writePointers.push_back(channel.data());
+    }
+    const size_t before = subnite::rt::GetNumViolations();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        // the events are pushed from the control side, only the processing has to be realtime safe
+        plugin.PushParameterEvent(PluginParameter::Power, static_cast<float>(i % 2), preparedSize / 3);
+        plugin.PushParameterEvent(PluginParameter::Power, 0.5f, preparedSize + 7); // lands in the next block
+
+        // twice the prepared size gets split by the plugin
+        for (size_t blockSize : { preparedSize * 2, preparedSize, size_t{1} }) {
+            subnite::rt::ScopedRealtimeSection realtime;
+            plugin.Process(readPointers.data(), writePointers.data(), blockSize, numChannels);
+        }
+    }
+    return subnite::rt::GetNumViolations() - before;
+}
+
+} // namespace
+
+// usage: realtime_check [iterations per setting]
+// Runs processBlock with every bus setting below inside a realtime section. @return 1 if anything allocated, locked or blocked.
+int main(int argc, char** argv) {
+    const auto iterations = subnite::ParseCountArgument(argc, argv, 1, 16);
+    if (!iterations) {
+        std::printf("usage: realtime_check [iterations per setting]\n");
+        return 1;
+    }
+    const double sampleRates[] = { 44100.0, 48000.0, 96000.0, 192000.0 };
+    const size_t channelCounts[] = { 1, 2, 6, 12, 16 }; // mono, stereo, 5.1, 7.1.4, 3rd order ambisonics
+    const size_t preparedSizes[] = { 16, 64, 256, 512, 1024, 4096 };
+    const size_t maxBufferSize = 4096;
+
+    JuceInit juceInit{MessageThreadMode::Headless}; // pure DSP, no message loop needed
+    subnite::rt::SetViolationHandler(PrintFirstViolations);
+    subnite::rt::ResetViolations();
+
+    MyPluginProcessor processor{};
+    Plugin plugin{};
+    size_t numFailedSettings = 0;
+
+    for (double sampleRate : sampleRates) {
+        for (size_t numChannels : channelCounts) {
+            for (size_t preparedSize : preparedSizes) {
+                // preparing is allowed to allocate, only processing isn't
+                processor.prepareToPlayFull(sampleRate, preparedSize, numChannels, numChannels, maxBufferSize);
+                plugin.Prepare(sampleRate, preparedSize, numChannels, numChannels, maxBufferSize);
+
+                size_t violations = CheckProcessor<float>(processor, numChannels, preparedSize, *iterations)
+                    + CheckProcessor<double>(processor, numChannels, preparedSize, *iterations)
+                    + CheckPlugin<float>(plugin, numChannels, preparedSize, *iterations)
+                    + CheckPlugin<double>(plugin, numChannels, preparedSize, *iterations);
+
+                if (violations > 0) {
+                    ++numFailedSettings;
+                    std::printf("FAILED: %6.0f Hz, %zu channel(s), %4zu samples: %zu violation(s)\n", sampleRate, numChannels, preparedSize, violations);
+                }
+            }
+        }
+    }
+
+    subnite::rt::SetViolationHandler(nullptr);
+    std::printf("%zu violation(s) in %zu failed setting(s)\n", subnite::rt::GetNumViolations(), numFailedSettings);
+    return numFailedSettings == 0 ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+#include "plugin.h"
+#include "juce_init.h"
+#include "subnite_extras/common/parse_count.hpp"
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace subnite::dynlib;
+
+namespace {
+
+struct RenderOptions {
+    std::vector<juce::File> inputs;
+    std::optional<juce::File> outputDir;
+    size_t numThreads = 0; // 0: one per core
+    size_t blockSize = 512;
+};
+
+struct RenderTotals {
+    std::atomic<uint64_t> frames{0};
+    std::atomic<uint64_t> samples{0}; // frames * channels
+    std::atomic<double> audioSeconds{0.0};
+    std::atomic<size_t> failedFiles{0};
+};
+
+std::mutex printMutex;
+
+void PrintUsage() {
+    std::cout << "usage: render [-o output/dir] [-j threads] [-b blockSize] input1.wav input2.wav ...\n";
+    std::cout << "  -j  worker threads, at least 1 (default: one per core)\n";
+    std::cout << "  -b  samples per block, at least 1 (default: 512)\n";
+}
+
+std::optional<RenderOptions> ParseArgs(int argc, char** argv) {
+    RenderOptions options;
+    auto cwd = juce::File::getCurrentWorkingDirectory();
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg{argv[i]};
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "-o" && hasValue) options.outputDir = cwd.getChildFile(argv[++i]);
+        else if ((arg == "-j" || arg == "-b") && hasValue) {
+            auto count = subnite::ParseCount(argv[++i]);
+            if (!count) return std::nullopt;
+            (arg == "-j" ? options.numThreads : options.blockSize) = *count;
+        }
+        else if (arg.starts_with("-")) return std::nullopt;
+        else options.inputs.push_back(cwd.getChildFile(arg));
+    }
+
+    if (options.inputs.empty()) return std::nullopt;
+    return options;
+}
+
+juce::File GetOutputFile(const RenderOptions& options, const juce::File& input) {
+    auto name = input.getFileNameWithoutExtension() + "_rendered.wav";
+    if (options.outputDir) return options.outputDir->getChildFile(name);
+    return input.getSiblingFile(name);
+}
+
+// streams one file through the plugin in blocks of options.blockSize. @return false if it failed.
+bool RenderFile(Plugin& plugin, const RenderOptions& options, const juce::File& input, RenderTotals& totals) {
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader{formatManager.createReaderFor(input)};
+    if (reader == nullptr) return false;
+
+    const auto numChannels = static_cast<size_t>(reader->numChannels);
+    const auto blockSize = static_cast<int>(options.blockSize);
+    if (plugin.Prepare(reader->sampleRate, options.blockSize, numChannels, numChannels) != PluginResult::Success)
+        return false;
+
+    auto outputFile = GetOutputFile(options, input);
+    outputFile.deleteFile();
+    std::unique_ptr<juce::OutputStream> outStream{outputFile.createOutputStream()};
+    if (outStream == nullptr) return false;
+
+    juce::WavAudioFormat wavFormat;
+    std::unique_ptr<juce::AudioFormatWriter> writer{wavFormat.createWriterFor(
+        outStream.get(), reader->sampleRate, reader->numChannels, static_cast<int>(reader->bitsPerSample), {}, 0)};
+    if (writer == nullptr) return false;
+    outStream.release(); // the writer owns it now
+
+    juce::AudioBuffer<float> buffer{static_cast<int>(numChannels), blockSize};
+    std::vector<const float*> inPointers(numChannels);
+    std::vector<float*> outPointers(numChannels);
+    for (size_t channel = 0; channel < numChannels; ++channel) {
+        outPointers[channel] = buffer.getWritePointer(static_cast<int>(channel));
+        inPointers[channel] = outPointers[channel]; // in place, so Process doesn't copy
+    }
+
+    for (juce::int64 position = 0; position < reader->lengthInSamples; position += blockSize) {
+        auto numSamples = static_cast<int>(std::min<juce::int64>(blockSize, reader->lengthInSamples - position));
+        if (!reader->read(&buffer, 0, numSamples, position, true, true)) return false;
+
+        auto result = plugin.Process(inPointers.data(), outPointers.data(), static_cast<size_t>(numSamples), numChannels);
+        if (result != PluginResult::Success) return false;
+
+        if (!writer->writeFromAudioSampleBuffer(buffer, 0, numSamples)) return false;
+    }
+
+    const auto frames = static_cast<uint64_t>(reader->lengthInSamples);
+    totals.frames += frames;
+    totals.samples += frames * numChannels;
+    totals.audioSeconds += static_cast<double>(reader->lengthInSamples) / reader->sampleRate;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    auto options = ParseArgs(argc, argv);
+    if (!options) {
+        PrintUsage();
+        return 1;
+    }
+
+    JuceInit juceInit{MessageThreadMode::Headless}; // pure DSP, no message loop needed
+
+    size_t numThreads = options->numThreads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : options->numThreads;
+    numThreads = std::min(numThreads, options->inputs.size());
+
+    RenderTotals totals;
+    std::atomic<size_t> nextFile{0};
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (size_t worker = 0; worker < numThreads; ++worker) {
+        workers.emplace_back([&] {
+            Plugin plugin{}; // one per worker, re-prepared for every file
+            for (size_t index = nextFile++; index < options->inputs.size(); index = nextFile++) {
+                const auto& input = options->inputs[index];
+                bool succeeded = RenderFile(plugin, *options, input, totals);
+                if (!succeeded) ++totals.failedFiles;
+
+                std::lock_guard<std::mutex> lock{printMutex};
+                std::cout << (succeeded ? "rendered: " : "FAILED:   ") << input.getFullPathName() << "\n";
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double audioSeconds = totals.audioSeconds.load();
+
+    std::cout << "\nfiles:          " << options->inputs.size() - totals.failedFiles << "/" << options->inputs.size() << "\n";
+    std::cout << "threads:        " << numThreads << "\n";
+    std::cout << "wall time:      " << wallSeconds << " s\n";
+    std::cout << "frames/sec:     " << static_cast<double>(totals.frames.load()) / wallSeconds << "\n";
+    std::cout << "samples/sec:    " << static_cast<double>(totals.samples.load()) / wallSeconds << "\n";
+    std::cout << "realtime factor " << audioSeconds / wallSeconds << "x\n";
+
+    return totals.failedFiles == 0 ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include "value_tree_manager.h"
+
+namespace subnite::vt {
+
+// Parses trees (ValueTreeBase::ReadTree, or the readTree passed in) on a worker pool shared by every instance, and hands them to the message thread.
+// Only the newest Load counts: older ones that haven't been parsed yet are skipped, and older results are dropped.
+// Meant for setStateInformation, so big states and preset browsing don't stall the calling thread.
+class AsyncTreeLoader : private juce::AsyncUpdater {
+public:
+    // parses on the workers, so it mustn't touch anything the loader's owner owns
+    using ReadFunction = juce::ValueTree (*)(const void* data, size_t size);
+
+    // onLoaded is called on the message thread with the parsed tree, which is invalid when the data was broken
+    explicit AsyncTreeLoader(std::function<void(juce::ValueTree)> onLoaded, ReadFunction readTree = DefaultRead)
+        : m_onLoaded(std::move(onLoaded)), m_read(readTree) {
+        m_inbox->owner = this;
+    }
+
+    ~AsyncTreeLoader() override {
+        {
+            std::lock_guard<std::mutex> lock{m_inbox->mutex};
+            m_inbox->owner = nullptr; // a job that's still running finds nobody to tell
+        }
+        cancelPendingUpdate();
+    }
+
+    AsyncTreeLoader(const AsyncTreeLoader&) = delete;
+    AsyncTreeLoader& operator=(const AsyncTreeLoader&) = delete;
+
+    // any thread. Copies the data, so it can be freed right after.
+    void Load(const void* data, size_t size) {
+        auto request = std::make_shared<const juce::MemoryBlock>(data, size);
+        uint64_t generation = 0;
+        {
+            std::lock_guard<std::mutex> lock{m_inbox->mutex};
+            generation = ++m_inbox->requestedGeneration;
+            m_inbox->request = request;
+            m_inbox->result = {};
+        }
+
+        m_pool->pool.addJob([inbox = m_inbox, read = m_read, request, generation] {
+            if (inbox->IsSuperseded(generation)) return; // a newer Load came in before this one got its turn
+            auto tree = read(request->getData(), request->getSize());
+
+            std::lock_guard<std::mutex> lock{inbox->mutex};
+            if (generation != inbox->requestedGeneration || inbox->owner == nullptr) return;
+            inbox->result = std::move(tree);
+            inbox->resultGeneration = generation;
+            inbox->owner->triggerAsyncUpdate();
+        });
+    }
+
+    // any thread. Drops whatever is pending, for when the tree gets replaced some other way.
+    void Cancel() {
+        std::lock_guard<std::mutex> lock{m_inbox->mutex};
+        m_inbox->deliveredGeneration = ++m_inbox->requestedGeneration;
+        m_inbox->request.reset();
+        m_inbox->result = {};
+    }
+
+    // any thread. @return true while the newest Load hasn't reached onLoaded yet
+    bool IsPending() const {
+        std::lock_guard<std::mutex> lock{m_inbox->mutex};
+        return m_inbox->deliveredGeneration != m_inbox->requestedGeneration;
+    }
+
+    // any thread. Copies the data of the newest Load into dest while it's pending, so a getStateInformation in between returns what the host just set.
+    // @return false if nothing is pending
+    bool GetPendingData(juce::MemoryBlock& dest) const {
+        std::lock_guard<std::mutex> lock{m_inbox->mutex};
+        if (m_inbox->deliveredGeneration == m_inbox->requestedGeneration || m_inbox->request == nullptr) return false;
+        dest = *m_inbox->request;
+        return true;
+    }
+
+private:
+    // outlives the loader while jobs still hold it
+    struct Inbox {
+        std::mutex mutex;
+        AsyncTreeLoader* owner = nullptr;
+        std::shared_ptr<const juce::MemoryBlock> request;
+        juce::ValueTree result;
+        uint64_t requestedGeneration = 0;
+        uint64_t resultGeneration = 0;
+        uint64_t deliveredGeneration = 0;
+
+        bool IsSuperseded(uint64_t generation) {
+            std::lock_guard<std::mutex> lock{mutex};
+            return generation != requestedGeneration || owner == nullptr;
+        }
+    };
+
+    // one small pool for all instances, so hundreds of them don't keep hundreds of idle threads
+    struct SharedPool {
+        juce::ThreadPool pool{juce::ThreadPoolOptions{}.withThreadName("Tree loader").withNumberOfThreads(2)};
+    };
+
+    static juce::ValueTree DefaultRead(const void* data, size_t size) { return ValueTreeBase::ReadTree(data, size); }
+
+    void handleAsyncUpdate() override {
+        juce::ValueTree tree;
+        {
+            std::lock_guard<std::mutex> lock{m_inbox->mutex};
+            if (m_inbox->resultGeneration != m_inbox->requestedGeneration || m_inbox->deliveredGeneration == m_inbox->requestedGeneration) return;
+            tree = std::move(m_inbox->result);
+            m_inbox->result = {};
+            m_inbox->request.reset();
+            m_inbox->deliveredGeneration = m_inbox->resultGeneration;
+        }
+        m_onLoaded(std::move(tree));
+    }
+
+    std::function<void(juce::ValueTree)> m_onLoaded;
+    ReadFunction m_read;
+    std::shared_ptr<Inbox> m_inbox = std::make_shared<Inbox>();
+    juce::SharedResourcePointer<SharedPool> m_pool;
+};
+
+} // namespace
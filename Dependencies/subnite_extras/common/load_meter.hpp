@@ -0,0 +1,99 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+
+namespace subnite {
+
+// Records how long every block took relative to its budget (numSamples / sampleRate), as a histogram and a ring of recent loads.
+// One thread records (the audio thread, never blocks or allocates), any thread can read. Reads are a consistent-enough view, not a snapshot.
+class LoadMeter {
+public:
+    static constexpr size_t numBins = 32;
+    static constexpr double binWidth = 0.05; // 5% of the budget per bin, the last bin holds everything from 155% up
+    static constexpr size_t historySize = 256;
+
+    struct Stats {
+        uint64_t numBlocks = 0;
+        uint64_t numOverruns = 0; // blocks that took longer than their budget
+        float averageLoad = 0.f;  // of the recent blocks, 1 = the whole budget
+        float peakLoad = 0.f;     // since the last Reset
+        std::array<uint64_t, numBins> histogram{};
+    };
+
+    // audio thread, measures from construction to destruction
+    class ScopedMeasurement {
+    public:
+        ScopedMeasurement(LoadMeter& meter, int numSamples, double sampleRate)
+            : m_meter(meter), m_budgetSeconds(sampleRate > 0.0 ? numSamples / sampleRate : 0.0) {}
+        ~ScopedMeasurement() {
+            m_meter.Record(std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count(), m_budgetSeconds);
+        }
+        ScopedMeasurement(const ScopedMeasurement&) = delete;
+        ScopedMeasurement& operator=(const ScopedMeasurement&) = delete;
+
+    private:
+        LoadMeter& m_meter;
+        double m_budgetSeconds;
+        std::chrono::steady_clock::time_point m_start = std::chrono::steady_clock::now();
+    };
+
+    // writer side
+    void Record(double elapsedSeconds, double budgetSeconds) {
+        if (budgetSeconds <= 0.0) return;
+        const auto load = static_cast<float>(elapsedSeconds / budgetSeconds);
+
+        const auto bin = std::min(static_cast<size_t>(load / binWidth), numBins - 1);
+        m_bins[bin].fetch_add(1, std::memory_order_relaxed);
+        if (load > 1.f) m_numOverruns.fetch_add(1, std::memory_order_relaxed);
+        if (load > m_peakLoad.load(std::memory_order_relaxed)) m_peakLoad.store(load, std::memory_order_relaxed);
+
+        const size_t index = m_numBlocks.load(std::memory_order_relaxed);
+        m_recent[index % historySize].store(load, std::memory_order_relaxed);
+        m_numBlocks.store(index + 1, std::memory_order_release);
+    }
+
+    // reader side
+    Stats GetStats() const {
+        Stats stats;
+        stats.numBlocks = m_numBlocks.load(std::memory_order_acquire);
+        stats.numOverruns = m_numOverruns.load(std::memory_order_relaxed);
+        stats.peakLoad = m_peakLoad.load(std::memory_order_relaxed);
+        for (size_t bin = 0; bin < numBins; ++bin)
+            stats.histogram[bin] = m_bins[bin].load(std::memory_order_relaxed);
+
+        const size_t numRecent = static_cast<size_t>(std::min<uint64_t>(stats.numBlocks, historySize));
+        float sum = 0.f;
+        for (size_t i = 0; i < numRecent; ++i) sum += m_recent[i].load(std::memory_order_relaxed);
+        stats.averageLoad = numRecent > 0 ? sum / static_cast<float>(numRecent) : 0.f;
+        return stats;
+    }
+
+    // Copies up to maxCount recent loads into dest, oldest first. @return how many were copied
+    size_t GetRecentLoads(float* dest, size_t maxCount) const {
+        const uint64_t numBlocks = m_numBlocks.load(std::memory_order_acquire);
+        const size_t count = static_cast<size_t>(std::min<uint64_t>({numBlocks, historySize, maxCount}));
+        for (size_t i = 0; i < count; ++i)
+            dest[i] = m_recent[(numBlocks - count + i) % historySize].load(std::memory_order_relaxed);
+        return count;
+    }
+
+    // reader side, blocks recorded at the same time can end up on either side of it
+    void Reset() {
+        for (auto& bin : m_bins) bin.store(0, std::memory_order_relaxed);
+        m_numOverruns.store(0, std::memory_order_relaxed);
+        m_peakLoad.store(0.f, std::memory_order_relaxed);
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, numBins> m_bins{};
+    std::array<std::atomic<float>, historySize> m_recent{};
+    std::atomic<uint64_t> m_numBlocks{0};
+    std::atomic<uint64_t> m_numOverruns{0};
+    std::atomic<float> m_peakLoad{0.f};
+};
+
+} // namespace
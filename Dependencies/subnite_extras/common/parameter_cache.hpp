@@ -0,0 +1,133 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <atomic>
+#include <juce_data_structures/juce_data_structures.h>
+#include "value_tree_manager.h"
+
+namespace subnite::vt {
+
+// Mirrors the numeric properties of a tree that are in its IDMap, so the audio thread can read them as plain floats.
+// The thread that changes the tree (normally the message thread) writes atomic slots through a ValueTree::Listener.
+// That's a single writer: never change the tree from two threads at once, or a snapshot can tear.
+// The audio thread calls Update() once per block, which copies the slots into a snapshot that stays the same for the whole block.
+// Writes are published like a seqlock: when a copy overlaps a write, the previous snapshot is kept and the next block tries again,
+// so the audio thread never waits and never sees half of a Resync.
+template <EnumType E_ID>
+class ParameterCache : private juce::ValueTree::Listener {
+public:
+    static constexpr size_t numIDs = IDMap<E_ID>::numIDs;
+    static constexpr size_t cacheLineSize = 64;
+    using Values = std::array<float, numIDs>;
+
+    // tree and ids are usually the same object (myplugin::vt::ValueTree), both have to outlive the cache
+    ParameterCache(ValueTreeBase& tree, const IDMap<E_ID>& ids) : m_tree(tree), m_ids(ids) {
+        m_tree.AddListener(this);
+        Resync();
+    }
+    ~ParameterCache() override { m_tree.RemoveListener(this); }
+    ParameterCache(const ParameterCache&) = delete;
+    ParameterCache& operator=(const ParameterCache&) = delete;
+
+    // writer side. Reads every mapped property in the tree again, published as one change.
+    void Resync() {
+        BeginWrite();
+        WriteTree(m_tree.GetRoot());
+        EndWrite();
+    }
+
+    // @return The last value written to the tree, from any thread. Not part of a snapshot.
+    float GetLatest(E_ID type) const {
+        return m_slots[static_cast<size_t>(type)].value.load(std::memory_order_relaxed);
+    }
+
+    // audio thread, at the start of every block. @return The snapshot for this block.
+    const Values& Update() {
+        const uint64_t sequence = m_sequence.load(std::memory_order_acquire);
+        if (sequence == m_lastSequence || (sequence & 1) != 0) return m_snapshots[m_front];
+
+        auto& back = m_snapshots[1 - m_front];
+        for (size_t index = 0; index < numIDs; ++index)
+            back[index] = m_slots[index].value.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_sequence.load(std::memory_order_relaxed) != sequence) return m_snapshots[m_front]; // torn, the next block gets it
+
+        m_lastSequence = sequence;
+        m_front = 1 - m_front;
+        return m_snapshots[m_front];
+    }
+
+    // audio thread, from the snapshot of the current block
+    float Get(E_ID type) const { return m_snapshots[m_front][static_cast<size_t>(type)]; }
+    // audio thread, every value of the current block's snapshot (with its Overrides)
+    const Values& GetValues() const { return m_snapshots[m_front]; }
+
+    // audio thread. Changes the current snapshot until the tree changes again, for changes that reach the DSP without going through the tree.
+    void Override(E_ID type, float value) { m_snapshots[m_front][static_cast<size_t>(type)] = value; }
+
+private:
+    struct alignas(cacheLineSize) Slot {
+        std::atomic<float> value{0.f};
+    };
+
+    void BeginWrite() {
+        const uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void EndWrite() {
+        m_sequence.store(m_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void WriteProperty(const juce::ValueTree& tree, const juce::Identifier& property) {
+        auto type = m_ids.GetTypeFromID(property);
+        if (!type) return;
+
+        const auto& value = tree.getProperty(property);
+        if (!(value.isDouble() || value.isInt() || value.isInt64() || value.isBool())) return; // strings and objects aren't mirrored
+        m_slots[static_cast<size_t>(*type)].value.store(static_cast<float>(static_cast<double>(value)), std::memory_order_relaxed);
+    }
+
+    void WriteTree(const juce::ValueTree& tree) {
+        for (int index = 0; index < tree.getNumProperties(); ++index)
+            WriteProperty(tree, tree.getPropertyName(index));
+        for (const auto& child : tree)
+            WriteTree(child);
+    }
+
+    void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier& property) override {
+        BeginWrite();
+        WriteProperty(tree, property);
+        EndWrite();
+    }
+
+    void valueTreeChildAdded(juce::ValueTree& parent, juce::ValueTree& child) override {
+        juce::ignoreUnused(parent);
+        BeginWrite();
+        WriteTree(child);
+        EndWrite();
+    }
+
+    // the root was replaced (Create, CopyFrom, ...)
+    void valueTreeRedirected(juce::ValueTree& tree) override {
+        juce::ignoreUnused(tree);
+        Resync();
+    }
+
+    ValueTreeBase& m_tree;
+    const IDMap<E_ID>& m_ids;
+
+    // writer side
+    std::array<Slot, numIDs> m_slots{};
+    alignas(cacheLineSize) std::atomic<uint64_t> m_sequence{0}; // odd while a write is in progress
+
+    // audio thread side
+    alignas(cacheLineSize) std::array<Values, 2> m_snapshots{};
+    size_t m_front = 0;
+    uint64_t m_lastSequence = 0;
+};
+
+} // namespace
@@ -0,0 +1,89 @@
+#pragma once
+#include <stddef.h>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include "value_tree_manager.h"
+
+namespace subnite::vt {
+
+// Linear smoothing for every parameter of E_ID at once, in flat E_ID::COUNT sized arrays (structure of arrays).
+// The audio thread sets the targets (usually ParameterCache's snapshot), and Advance fills one contiguous per sample ramp
+// for all of them per chunk, so dozens of parameters don't each pay for their own smoother in the hot path.
+// Only Prepare allocates.
+template <EnumType E_ID>
+class ParameterSmoother {
+public:
+    static constexpr size_t numIDs = IDMap<E_ID>::numIDs;
+    static constexpr size_t cacheLineSize = 64;
+    using Values = std::array<float, numIDs>;
+
+    // allocates the ramps, call it from prepareToPlay. sampleRate and maxBlockSize are the ones the ramps are read at.
+    void Prepare(double sampleRate, size_t maxBlockSize, double smoothingSeconds = 0.02) {
+        m_maxBlockSize = maxBlockSize;
+        m_ramps.assign(numIDs * maxBlockSize, 0.f);
+        m_rampLength = 0;
+        m_smoothingSamples = std::max<size_t>(1, static_cast<size_t>(sampleRate * smoothingSeconds));
+        Snap();
+    }
+
+    // audio thread. Values that changed start ramping towards their new target from where they are now.
+    void SetTargets(const Values& targets) {
+        for (size_t index = 0; index < numIDs; ++index) {
+            if (targets[index] == m_target[index]) continue;
+            m_target[index] = targets[index];
+            m_step[index] = (m_target[index] - m_current[index]) / static_cast<float>(m_smoothingSamples);
+            m_stepsLeft[index] = m_smoothingSamples;
+        }
+    }
+
+    // audio thread. Jumps every parameter straight to its target, for when there's nothing to glide from (after a reset, or a chunk that wasn't processed).
+    void Snap() {
+        m_current = m_target;
+        m_stepsLeft.fill(0);
+    }
+
+    // audio thread, before every processed chunk. Fills the ramps of all parameters for the next numSamples and moves the current values along.
+    void Advance(size_t numSamples) {
+        jassert(numSamples <= m_maxBlockSize);
+        m_rampLength = std::min(numSamples, m_maxBlockSize);
+
+        // the inner loops have no dependencies between samples, so they vectorize
+        for (size_t index = 0; index < numIDs; ++index) {
+            float* ramp = m_ramps.data() + index * m_maxBlockSize;
+            const float start = m_current[index];
+            const float increment = m_step[index];
+            const size_t rampSteps = std::min(m_stepsLeft[index], m_rampLength);
+
+            for (size_t i = 0; i < rampSteps; ++i)
+                ramp[i] = start + increment * static_cast<float>(i + 1);
+            std::fill(ramp + rampSteps, ramp + m_rampLength, m_target[index]);
+        }
+
+        // move all parameters along at once
+        for (size_t index = 0; index < numIDs; ++index) {
+            const size_t advanced = std::min(m_stepsLeft[index], m_rampLength);
+            m_stepsLeft[index] -= advanced;
+            m_current[index] = m_stepsLeft[index] == 0 ? m_target[index] : m_current[index] + m_step[index] * static_cast<float>(advanced);
+        }
+    }
+
+    // audio thread. @return GetRampLength() smoothed values of type, one per sample of the last Advance
+    const float* GetRamp(E_ID type) const { return m_ramps.data() + static_cast<size_t>(type) * m_maxBlockSize; }
+    size_t GetRampLength() const { return m_rampLength; }
+    // @return true while type hasn't reached its target, so constant parameters can take a cheaper path
+    bool IsSmoothing(E_ID type) const { return m_stepsLeft[static_cast<size_t>(type)] != 0; }
+
+private:
+    alignas(cacheLineSize) Values m_current{};
+    alignas(cacheLineSize) Values m_target{};
+    alignas(cacheLineSize) Values m_step{};
+    alignas(cacheLineSize) std::array<size_t, numIDs> m_stepsLeft{};
+
+    std::vector<float> m_ramps; // numIDs * m_maxBlockSize, one contiguous ramp per parameter
+    size_t m_maxBlockSize = 0;
+    size_t m_rampLength = 0;
+    size_t m_smoothingSamples = 1;
+};
+
+} // namespace
@@ -0,0 +1,26 @@
+#pragma once
+#include <stddef.h>
+#include <charconv>
+#include <cstring>
+#include <optional>
+#include <system_error>
+
+namespace subnite {
+
+// command line counts (threads, blocks, iterations) without std::stoul, which throws on anything that isn't a number.
+// @return the value of text if all of it is a number of at least minValue
+inline std::optional<size_t> ParseCount(const char* text, size_t minValue = 1) {
+    const char* end = text + std::strlen(text);
+    size_t value = 0;
+    auto [last, error] = std::from_chars(text, end, value);
+    if (error != std::errc{} || last != end || value < minValue) return std::nullopt;
+    return value;
+}
+
+// @return argv[index] parsed by ParseCount, defaultValue when there's no such argument, and nullopt when it's malformed
+inline std::optional<size_t> ParseCountArgument(int argc, char** argv, int index, size_t defaultValue, size_t minValue = 1) {
+    if (index >= argc) return defaultValue;
+    return ParseCount(argv[index], minValue);
+}
+
+} // namespace
@@ -0,0 +1,96 @@
+/**
+ * @file realtime_check.h
+ * @author Subnite
+ * @brief flags allocations, locks and blocking calls made on the audio thread.
+ *
+ * Wrap the code that has to be realtime safe (usually a processBlock call) in a ScopedRealtimeSection.
+ * The hooks in realtime_check_hooks.cpp (only compiled with SUBNITE_REALTIME_CHECKS=1, and only meant for test executables)
+ * replace the global operator new/delete and, on linux, pthread locks and blocking calls, and report them while a section is active.
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <juce_core/juce_core.h>
+
+namespace subnite::rt
+{
+
+    enum class ViolationType { Allocation, Deallocation, Lock, BlockingCall };
+
+    inline const char *ToString(ViolationType type) {
+        switch (type) {
+            case ViolationType::Allocation:   return "allocation";
+            case ViolationType::Deallocation: return "deallocation";
+            case ViolationType::Lock:         return "lock";
+            case ViolationType::BlockingCall: return "blocking call";
+        }
+        return "unknown";
+    }
+
+    using ViolationHandler = void (*)(ViolationType type, const char *what);
+
+    namespace detail
+    {
+        inline thread_local int realtimeDepth = 0;
+        inline thread_local int suspendDepth = 0;
+        inline std::atomic<size_t> numViolations{0};
+        inline std::atomic<ViolationHandler> handler{nullptr};
+    }
+
+    /** Marks the current thread as realtime until it goes out of scope. Can be nested. */
+    struct ScopedRealtimeSection {
+        ScopedRealtimeSection() { ++detail::realtimeDepth; }
+        ~ScopedRealtimeSection() { --detail::realtimeDepth; }
+        ScopedRealtimeSection(const ScopedRealtimeSection &) = delete;
+        ScopedRealtimeSection &operator=(const ScopedRealtimeSection &) = delete;
+    };
+
+    /** Lets things through on purpose inside a realtime section, the checker uses it for its own reporting as well. */
+    struct ScopedRealtimeSuspend {
+        ScopedRealtimeSuspend() { ++detail::suspendDepth; }
+        ~ScopedRealtimeSuspend() { --detail::suspendDepth; }
+        ScopedRealtimeSuspend(const ScopedRealtimeSuspend &) = delete;
+        ScopedRealtimeSuspend &operator=(const ScopedRealtimeSuspend &) = delete;
+    };
+
+    inline bool IsInRealtimeSection() { return detail::realtimeDepth > 0 && detail::suspendDepth == 0; }
+
+    /** The default handler, prints what happened and the stack that did it. */
+    inline void PrintViolation(ViolationType type, const char *what) {
+        std::fprintf(stderr, "[realtime violation] %s in %s\n%s\n", ToString(type), what, juce::SystemStats::getStackBacktrace().toRawUTF8());
+    }
+
+    /** Replaces PrintViolation, pass nullptr to go back to it. */
+    inline void SetViolationHandler(ViolationHandler handler) { detail::handler = handler; }
+
+    inline size_t GetNumViolations() { return detail::numViolations.load(); }
+    inline void ResetViolations() { detail::numViolations = 0; }
+
+    /** Does nothing outside of a realtime section. Called by the hooks, call it yourself for blocking calls they can't see. */
+    inline void ReportViolation(ViolationType type, const char *what) {
+        if (!IsInRealtimeSection()) return;
+
+        ScopedRealtimeSuspend suspend; // reporting allocates and locks itself
+        ++detail::numViolations;
+        auto handler = detail::handler.load();
+        (handler != nullptr ? handler : PrintViolation)(type, what);
+    }
+
+    /** A lock that reports when it's taken in a realtime section, for platforms where the pthread hooks don't exist. */
+    template <typename Mutex = std::mutex>
+    class CheckedMutex {
+    public:
+        void lock() {
+            ReportViolation(ViolationType::Lock, "CheckedMutex::lock");
+            mutex.lock();
+        }
+        bool try_lock() { return mutex.try_lock(); } // doesn't block, so it's fine
+        void unlock() { mutex.unlock(); }
+
+    private:
+        Mutex mutex;
+    };
+
+} // namespace
@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+    Global hooks for realtime_check.h. Only compiled with SUBNITE_REALTIME_CHECKS=1,
+    never turn that on for the plugin itself since it replaces operator new for the whole process.
+
+  ==============================================================================
+*/
+
+#include "realtime_check.h"
+
+#if SUBNITE_REALTIME_CHECKS
+#include <cstdlib>
+#include <new>
+
+#if defined(__linux__)
+#include <dlfcn.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+using subnite::rt::ReportViolation;
+using subnite::rt::ViolationType;
+
+namespace {
+
+void* Allocate(std::size_t size, const char* what) {
+    ReportViolation(ViolationType::Allocation, what);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+    throw std::bad_alloc{};
+}
+
+void* AllocateAligned(std::size_t size, std::align_val_t alignment, const char* what) {
+    ReportViolation(ViolationType::Allocation, what);
+    const auto align = static_cast<std::size_t>(alignment);
+    const std::size_t rounded = (std::max<std::size_t>(size, 1) + align - 1) / align * align; // aligned_alloc wants a multiple
+    if (void* ptr = std::aligned_alloc(align, rounded)) return ptr;
+    throw std::bad_alloc{};
+}
+
+void Free(void* ptr, const char* what) noexcept {
+    if (ptr == nullptr) return;
+    ReportViolation(ViolationType::Deallocation, what);
+    std::free(ptr);
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return Allocate(size, "operator new"); }
+void* operator new[](std::size_t size) { return Allocate(size, "operator new[]"); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return AllocateAligned(size, alignment, "operator new"); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return AllocateAligned(size, alignment, "operator new[]"); }
+
+void operator delete(void* ptr) noexcept { Free(ptr, "operator delete"); }
+void operator delete[](void* ptr) noexcept { Free(ptr, "operator delete[]"); }
+void operator delete(void* ptr, std::size_t) noexcept { Free(ptr, "operator delete"); }
+void operator delete[](void* ptr, std::size_t) noexcept { Free(ptr, "operator delete[]"); }
+void operator delete(void* ptr, std::align_val_t) noexcept { Free(ptr, "operator delete"); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { Free(ptr, "operator delete[]"); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { Free(ptr, "operator delete"); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { Free(ptr, "operator delete[]"); }
+
+#if defined(__linux__)
+// forwards to the real libc function. The pointer is looked up lazily without a function static, since static guards lock themselves.
+#define SUBNITE_RT_FORWARD(name, what, ...)                                                       \
+    ReportViolation(what, #name);                                                                 \
+    static std::atomic<void*> real{nullptr};                                                      \
+    void* fn = real.load(std::memory_order_relaxed);                                              \
+    if (fn == nullptr) {                                                                          \
+        fn = dlsym(RTLD_NEXT, #name);                                                             \
+        real.store(fn, std::memory_order_relaxed);                                                \
+    }                                                                                             \
+    return reinterpret_cast<decltype(&::name)>(fn)(__VA_ARGS__);
+
+// glibc keeps an old condvar ABI around under GLIBC_2.2.5, and plain dlsym can return that one, which hangs or corrupts
+// the pthread_cond_t. The current ABI is versioned GLIBC_2.3.2, on architectures that came later it's the only version and dlsym is fine.
+#if defined(__GLIBC__)
+#define SUBNITE_RT_LOOKUP_COND(name) [] { void* versioned = dlvsym(RTLD_NEXT, #name, "GLIBC_2.3.2"); return versioned != nullptr ? versioned : dlsym(RTLD_NEXT, #name); }()
+#else
+#define SUBNITE_RT_LOOKUP_COND(name) dlsym(RTLD_NEXT, #name)
+#endif
+
+// same as SUBNITE_RT_FORWARD, for the pthread_cond functions
+#define SUBNITE_RT_FORWARD_COND(name, what, ...)                                                  \
+    ReportViolation(what, #name);                                                                 \
+    static std::atomic<void*> real{nullptr};                                                      \
+    void* fn = real.load(std::memory_order_relaxed);                                              \
+    if (fn == nullptr) {                                                                          \
+        fn = SUBNITE_RT_LOOKUP_COND(name);                                                        \
+        real.store(fn, std::memory_order_relaxed);                                                \
+    }                                                                                             \
+    return reinterpret_cast<decltype(&::name)>(fn)(__VA_ARGS__);
+
+extern "C" {
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) { SUBNITE_RT_FORWARD(pthread_mutex_lock, ViolationType::Lock, mutex) }
+int pthread_rwlock_rdlock(pthread_rwlock_t* lock) { SUBNITE_RT_FORWARD(pthread_rwlock_rdlock, ViolationType::Lock, lock) }
+int pthread_rwlock_wrlock(pthread_rwlock_t* lock) { SUBNITE_RT_FORWARD(pthread_rwlock_wrlock, ViolationType::Lock, lock) }
+int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex) { SUBNITE_RT_FORWARD_COND(pthread_cond_wait, ViolationType::BlockingCall, cond, mutex) }
+int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* time) { SUBNITE_RT_FORWARD_COND(pthread_cond_timedwait, ViolationType::BlockingCall, cond, mutex, time) }
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 30)
+// what std::condition_variable::wait_for uses, new enough to only have one version
+int pthread_cond_clockwait(pthread_cond_t* cond, pthread_mutex_t* mutex, clockid_t clock, const struct timespec* time) { SUBNITE_RT_FORWARD(pthread_cond_clockwait, ViolationType::BlockingCall, cond, mutex, clock, time) }
+#endif
+int sem_wait(sem_t* sem) { SUBNITE_RT_FORWARD(sem_wait, ViolationType::BlockingCall, sem) }
+int nanosleep(const struct timespec* duration, struct timespec* remaining) { SUBNITE_RT_FORWARD(nanosleep, ViolationType::BlockingCall, duration, remaining) }
+int usleep(useconds_t microseconds) { SUBNITE_RT_FORWARD(usleep, ViolationType::BlockingCall, microseconds) }
+ssize_t read(int fd, void* buffer, size_t count) { SUBNITE_RT_FORWARD(read, ViolationType::BlockingCall, fd, buffer, count) }
+ssize_t write(int fd, const void* buffer, size_t count) { SUBNITE_RT_FORWARD(write, ViolationType::BlockingCall, fd, buffer, count) }
+
+} // extern C
+
+#undef SUBNITE_RT_FORWARD
+#undef SUBNITE_RT_FORWARD_COND
+#undef SUBNITE_RT_LOOKUP_COND
+#endif // linux
+
+#endif // SUBNITE_REALTIME_CHECKS
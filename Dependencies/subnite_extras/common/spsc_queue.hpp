@@ -0,0 +1,46 @@
+#pragma once
+#include <stddef.h>
+#include <array>
+#include <atomic>
+
+namespace subnite {
+
+// Bounded, lock free single producer single consumer queue.
+// One thread pushes and one other thread pops, neither of them ever allocates or blocks.
+template<typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity has to be a power of two");
+    static constexpr size_t mask = Capacity - 1;
+
+    std::array<T, Capacity> m_items{};
+    alignas(64) std::atomic<size_t> m_head{0}; // next slot to pop, owned by the consumer
+    alignas(64) std::atomic<size_t> m_tail{0}; // next slot to push, owned by the producer
+
+public:
+    // producer side. @return false when the queue is full.
+    bool TryPush(const T& item) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity) return false;
+
+        m_items[tail & mask] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side. @return false when the queue is empty.
+    bool TryPop(T& item) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return false;
+
+        item = m_items[head & mask];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // only an estimate when the other side is busy
+    size_t Size() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+};
+
+} // namespace
@@ -6,12 +6,18 @@
  */
 
 #pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
 #include <optional>
-#include <unordered_map>
+#include <span>
+#include <utility>
 #include <type_traits>
 #include <concepts>
 #include <juce_core/juce_core.h>
 #include <juce_data_structures/juce_data_structures.h>
+#include "value_tree_snapshot.h"
 
 
 namespace subnite::vt
@@ -20,38 +26,65 @@ namespace subnite::vt
     template <typename E_ID>
     concept EnumType = std::is_enum_v<E_ID>;
 
+    /** The names of every E_ID, indexed by the enum. E_ID needs a COUNT entry at the end. */
     template <EnumType E_ID>
-    class IDMap
-    {
-    protected:
-        /**
-         * The map used for connecting an enum to id's
-         */
-        std::unordered_map<E_ID, juce::Identifier> map;
+    using IDNames = std::array<const char *, static_cast<size_t>(E_ID::COUNT)>;
 
-        /**
-         * @brief creates the mappings from E_ID to juce::Identifier
-         *
-         * you can access the this->map variable, and are supposed to fill it with all possible enums.
-         *
-         * example code:
-         * @code
-         * void setupMap() override {
-         *     this->map[E_ID::ROOT] = juce::Identifier{"RootName"};
-         *     this->map[E_ID::DELAY_SLIDER] = juce::Identifier{"DelaySlider"};
-         * }
-         * @endcode
-         */
-        virtual void SetupMap() = 0;
+    /**
+     * @brief Builds an IDNames table at compile time.
+     *
+     * Fails to compile when an enum is missing, listed twice, or out of range.
+     *
+     * example code:
+     * @code
+     * static constexpr auto names = subnite::vt::MakeIDNames<E_ID>({
+     *     {E_ID::ROOT, "RootName"},
+     *     {E_ID::DELAY_SLIDER, "DelaySlider"},
+     * });
+     * @endcode
+     */
+    template <EnumType E_ID, size_t N>
+    consteval IDNames<E_ID> MakeIDNames(const std::pair<E_ID, const char *> (&entries)[N]) {
+        IDNames<E_ID> names{};
+        for (const auto &[type, name] : entries) {
+            auto index = static_cast<size_t>(type);
+            if (index >= names.size()) throw "MakeIDNames: enum out of range";
+            if (names[index] != nullptr) throw "MakeIDNames: enum listed twice";
+            if (name == nullptr || name[0] == '\0') throw "MakeIDNames: identifiers can't be empty";
+            names[index] = name;
+        }
+        for (auto name : names)
+            if (name == nullptr) throw "MakeIDNames: not every enum has a name";
+        return names;
+    }
 
+    /**
+     * Connects an enum to juce::Identifiers in both directions.
+     *
+     * Enum to ID is an array index. ID to enum hashes the identifier's pooled string pointer into a small open addressing table,
+     * which works because juce interns identifiers: equal names always share the same pointer.
+     * Both tables are fixed size, so building the map only allocates for interning the names themselves.
+     */
+    template <EnumType E_ID>
+    class IDMap
+    {
     public:
-        /**
-         * Default IDMap constructor, doesn't do any setup.
-         *
-         * CALL setupMap() MANUALLY ON CONSTRUCTOR!!
-         * The juce vst3 helper crashes when this abstract class tries to call setupMap(), so do it yourself!
-         */
-        inline IDMap() {};
+        static constexpr size_t numIDs = static_cast<size_t>(E_ID::COUNT);
+
+        /** @param names Usually made with MakeIDNames, so missing enums are caught at compile time. */
+        explicit IDMap(const IDNames<E_ID> &names) {
+            for (size_t index = 0; index < numIDs; ++index) {
+                ids[index] = juce::Identifier{names[index]};
+
+                auto key = Key(ids[index]);
+                auto slot = Hash(key);
+                while (lookup[slot].key != nullptr) {
+                    jassert(lookup[slot].key != key); // two enums share a name
+                    slot = (slot + 1) & (lookupSize - 1);
+                }
+                lookup[slot] = {key, static_cast<E_ID>(index)};
+            }
+        }
 
         /**
          * get the enum linked with the id
@@ -59,14 +92,11 @@ namespace subnite::vt
          * @return The E_ID::enum linked with id, or std::nullopt if it wasn't found.
          */
         std::optional<E_ID> GetTypeFromID(const juce::Identifier &id) const {
-            auto it = std::find_if(map.begin(), map.end(), [&id](const std::pair<E_ID, juce::Identifier> &pair) {
-                return pair.second == id; // Find the pair where value matches
-            });
-
-            if (it != map.end()) {
-                return it->first; // Return key if value is found
+            auto key = Key(id);
+            for (auto slot = Hash(key); lookup[slot].key != nullptr; slot = (slot + 1) & (lookupSize - 1)) {
+                if (lookup[slot].key == key) return lookup[slot].type;
             }
-            return std::nullopt; // Return an empty optional if value is not found
+            return std::nullopt;
         }
 
         /**
@@ -76,12 +106,43 @@ namespace subnite::vt
          * @return The ID linked with the enum, or std::nullopt if not found.
          */
         std::optional<juce::Identifier> GetIDFromType(const E_ID &property) const {
-            auto it = map.find(property);
-            if (it != map.end()) {
-                return it->second; // Return value if key is found
-            }
+            if (auto id = FindID(property)) return *id;
             return std::nullopt;
         }
+
+        /** Same as GetIDFromType without copying. @return nullptr when property is out of range. */
+        const juce::Identifier *FindID(E_ID property) const {
+            auto index = static_cast<size_t>(property);
+            return index < numIDs ? &ids[index] : nullptr;
+        }
+
+        /** @return Every ID, indexed by the enum. What snapshot::Read needs for snapshots written with this map. */
+        std::span<const juce::Identifier> GetIDs() const { return ids; }
+
+        /** @return The ID linked with property, which has to be in range. */
+        const juce::Identifier &GetID(E_ID property) const {
+            jassert(static_cast<size_t>(property) < numIDs);
+            return ids[static_cast<size_t>(property)];
+        }
+
+    private:
+        struct Slot {
+            const char *key = nullptr;
+            E_ID type{};
+        };
+
+        // at most half full, so probes stay short
+        static constexpr size_t lookupSize = std::bit_ceil(std::max<size_t>(numIDs * 2, 2));
+
+        static const char *Key(const juce::Identifier &id) { return id.getCharPointer().getAddress(); }
+
+        static size_t Hash(const char *key) {
+            auto bits = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(key));
+            return static_cast<size_t>((bits * 0x9E3779B97F4A7C15ull) >> 32) & (lookupSize - 1);
+        }
+
+        std::array<juce::Identifier, numIDs> ids{};
+        std::array<Slot, lookupSize> lookup{};
     };
 
     /*
@@ -125,12 +186,28 @@ namespace subnite::vt
     /** Adds a listener to the root tree. */
     inline void AddListener(juce::ValueTree::Listener *listener) { vtRoot.addListener(listener); }
 
+    /** Removes a listener added with AddListener. */
+    inline void RemoveListener(juce::ValueTree::Listener *listener) { vtRoot.removeListener(listener); }
+
     /** @return The undo manager used for all things. Could be nullptr */
     inline juce::UndoManager *GetUndoManager() { return &undoManager; }
 
-    /** Replaces the current tree with the tree found in the data. @return true when the tree is valid.*/
+    /** Parses a tree in the snapshot format (see value_tree_snapshot.h) or juce's own. Doesn't touch any ValueTreeBase, so it's safe on any thread.
+     *  @param enumIds For snapshots written without an id table (IDMap::GetIDs of the same enum), WriteCompactToStream doesn't need them.
+     *  @return The tree, or an invalid tree when the data was broken. */
+    static inline juce::ValueTree ReadTree(const void *data, size_t size, std::span<const juce::Identifier> enumIds = {}) {
+        if (snapshot::IsSnapshot(data, size)) return snapshot::ReadTree(data, size, enumIds);
+        return juce::ValueTree::readFromData(data, size); // older states, or trees the snapshot format can't store
+    }
+
+    /** Replaces the current tree with the tree found in the data, in the snapshot format or juce's own. @return true when the tree is valid.*/
     inline bool CopyFrom(const void *data, int sizeInBytes) {
-        vtRoot = juce::ValueTree::readFromData(data, static_cast<size_t>(sizeInBytes));
+        return ReplaceRoot(ReadTree(data, static_cast<size_t>(sizeInBytes)));
+    }
+
+    /** Replaces the current tree with newRoot (from ReadTree for example), the listeners move along. @return true when the tree is valid.*/
+    inline bool ReplaceRoot(const juce::ValueTree &newRoot) {
+        vtRoot = newRoot;
         return vtRoot.isValid();
     }
 
@@ -139,6 +216,17 @@ namespace subnite::vt
      * */
     inline void WriteToStream(juce::OutputStream &stream) const { vtRoot.writeToStream(stream); }
 
+    /** Writes the current tree as a snapshot with its own id table (see value_tree_snapshot.h), which CopyFrom reads as well.
+     *  Falls back to WriteToStream when the tree has values the snapshot format can't store.
+     *  @param compress Compresses it with zlib when that makes it smaller.
+     * */
+    inline void WriteCompactToStream(juce::OutputStream &stream, bool compress = true) const { WriteCompactToStream(vtRoot, stream, compress); }
+
+    /** Same for any tree, a copy of the root for example. */
+    static inline void WriteCompactToStream(const juce::ValueTree &tree, juce::OutputStream &stream, bool compress = true) {
+        if (!snapshot::WriteToStream(tree, stream, compress)) tree.writeToStream(stream);
+    }
+
     /** Writes the root tree structure to an XML file. Example path: "C:/Dev/tree.xml" */
     inline void CreateXML(const juce::String &pathToFile) const {
         auto xml = vtRoot.toXmlString();
@@ -151,6 +239,11 @@ namespace subnite::vt
     /** @return The root vtRoot */
     inline const juce::ValueTree &GetRoot() const { return vtRoot; }
 
+    /** Sets a property of the root tree, without undo unless undoable is true. */
+    inline void SetProperty(const juce::Identifier &id, const juce::var &value, bool undoable = false) {
+        vtRoot.setProperty(id, value, undoable ? &undoManager : nullptr);
+    }
+
     /** Recursively looks for a sub-tree matching the ID (not optimized)
      *  @param id The id to look for.
      *  @param tree The parent to start searching from.
@@ -0,0 +1,565 @@
+/**
+ * @file value_tree_snapshot.h
+ * @author Subnite
+ * @brief compact, versioned binary snapshots of a juce::ValueTree, for the dyn_lib snapshots and the plugin state alike.
+ *
+ */
+
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <juce_core/juce_core.h>
+#include <juce_data_structures/juce_data_structures.h>
+
+namespace subnite::vt::snapshot
+{
+
+    /**
+     * Layout (little endian):
+     * @code
+     * header:   u32 magic "SVTS", u16 version, u16 flags
+     * then:     body, or u32 size of the body + the body zlib compressed when flags has compressedFlag
+     * body:     [u16 numIds, numIds * (u16 length + utf8 bytes) when flags has idTableFlag], node
+     * node:     id, u16 numProperties, numProperties * (id, value), u16 numChildren, numChildren * node
+     * id:       u8 IdKind, then u16 index (Indexed) or u16 length + utf8 bytes (String)
+     * value:    u8 ValueType, then nothing (Void), u8 (Bool), i32 (Int), i64 (Int64), f64 (Double) or u32 length + utf8 bytes (String)
+     * @endcode
+     * Indexed ids point into the id table when there is one. Without one they are enum indices, which is what the allocation free
+     * snapshots use, and reading them needs the same enum's identifiers. The plugin state is stored with the table, since enum
+     * indices can change between versions and names don't.
+     */
+    constexpr uint32_t magic = 0x53545653; // "SVTS"
+    constexpr uint16_t version = 1;
+    constexpr uint16_t idTableFlag = 1;
+    constexpr uint16_t compressedFlag = 2;
+    constexpr uint16_t knownFlags = idTableFlag | compressedFlag;
+    constexpr size_t headerSize = 8;
+    constexpr size_t minCompressSize = 256; // smaller bodies don't shrink enough to be worth it
+    constexpr int maxDepth = 256;           // deeper trees in the data are treated as broken, so they can't overflow the stack
+
+    enum class IdKind : uint8_t { Indexed, String };
+    enum class ValueType : uint8_t { Void, Bool, Int, Int64, Double, String };
+
+    /** Writes into a fixed buffer. Keeps counting after it ran out of space (or without one), so the required size is always known. */
+    class Writer
+    {
+    public:
+        Writer(void *destination, size_t destCapacity) : dest(static_cast<uint8_t *>(destination)), capacity(destCapacity) {}
+
+        template <typename T>
+        void Write(T value) {
+            if constexpr (std::is_enum_v<T>) {
+                Write(static_cast<std::underlying_type_t<T>>(value));
+            } else if constexpr (std::is_floating_point_v<T>) {
+                static_assert(sizeof(T) == 8);
+                Write(std::bit_cast<uint64_t>(value));
+            } else {
+                if constexpr (std::endian::native == std::endian::big) value = std::byteswap(value);
+                WriteBytes(&value, sizeof(T));
+            }
+        }
+
+        void WriteBytes(const void *src, size_t numBytes) {
+            if (dest != nullptr && written + numBytes <= capacity)
+                std::memcpy(dest + written, src, numBytes);
+            else
+                overflowed = true;
+            written += numBytes;
+        }
+
+        size_t written = 0;
+        bool overflowed = false;
+
+    private:
+        uint8_t *dest;
+        size_t capacity;
+    };
+
+    /** Bounds checked reads. Once a read failed, all reads after it fail too. */
+    class Reader
+    {
+    public:
+        Reader(const void *snapshotData, size_t snapshotSize) : data(static_cast<const uint8_t *>(snapshotData)), size(snapshotSize) {}
+
+        template <typename T>
+        bool Read(T &value) {
+            if constexpr (std::is_enum_v<T>) {
+                std::underlying_type_t<T> raw{};
+                if (!Read(raw)) return false;
+                value = static_cast<T>(raw);
+                return true;
+            } else if constexpr (std::is_floating_point_v<T>) {
+                static_assert(sizeof(T) == 8);
+                uint64_t raw = 0;
+                if (!Read(raw)) return false;
+                value = std::bit_cast<T>(raw);
+                return true;
+            } else {
+                auto *bytes = ReadBytes(sizeof(T));
+                if (bytes == nullptr) return false;
+                std::memcpy(&value, bytes, sizeof(T));
+                if constexpr (std::endian::native == std::endian::big) value = std::byteswap(value);
+                return true;
+            }
+        }
+
+        /** @return A pointer into the data, or nullptr if there weren't enough bytes left. */
+        const char *ReadBytes(size_t numBytes) {
+            if (failed || numBytes > size - position) {
+                failed = true;
+                return nullptr;
+            }
+            auto *bytes = reinterpret_cast<const char *>(data + position);
+            position += numBytes;
+            return bytes;
+        }
+
+        bool IsAtEnd() const { return !failed && position == size; }
+        bool failed = false;
+
+    private:
+        const uint8_t *data;
+        size_t size;
+        size_t position = 0;
+    };
+
+    /** The identifiers of one tree in the order they were first seen, for the id table. Keyed by the pooled string, so no string compares. */
+    class IdTable
+    {
+    public:
+        /** @return false when there are more identifiers than an index can hold */
+        bool Add(const juce::Identifier &id) {
+            auto [it, inserted] = indices.try_emplace(id.getCharPointer().getAddress(), static_cast<uint16_t>(ids.size()));
+            if (inserted) ids.push_back(id);
+            return ids.size() <= 0xffff;
+        }
+
+        /** Same lookup as IDMap::GetTypeFromID, so the writer takes either. */
+        std::optional<uint16_t> GetTypeFromID(const juce::Identifier &id) const {
+            auto it = indices.find(id.getCharPointer().getAddress());
+            if (it == indices.end()) return std::nullopt;
+            return it->second;
+        }
+
+        std::vector<juce::Identifier> ids;
+
+    private:
+        std::unordered_map<const char *, uint16_t> indices;
+    };
+
+    namespace detail
+    {
+        struct ParsedID {
+            IdKind kind = IdKind::Indexed;
+            uint16_t index = 0;
+            const char *text = nullptr;
+            uint16_t length = 0;
+
+            bool Matches(const juce::Identifier &id, std::span<const juce::Identifier> ids) const {
+                if (kind == IdKind::Indexed) return ids[index] == id; // interned, so this compares pointers
+
+                auto idText = id.getCharPointer();
+                return idText.sizeInBytes() == static_cast<size_t>(length) + 1 && std::memcmp(idText.getAddress(), text, length) == 0;
+            }
+
+            std::optional<juce::Identifier> ToIdentifier(std::span<const juce::Identifier> ids) const {
+                if (kind == IdKind::Indexed) return ids[index];
+                if (length == 0) return std::nullopt; // identifiers can't be empty
+                return juce::Identifier{juce::String::fromUTF8(text, length)};
+            }
+        };
+
+        struct ParsedValue {
+            ValueType type = ValueType::Void;
+            bool boolValue = false;
+            int32_t intValue = 0;
+            int64_t int64Value = 0;
+            double doubleValue = 0.0;
+            const char *text = nullptr;
+            uint32_t length = 0;
+
+            juce::var ToVar() const {
+                switch (type) {
+                    case ValueType::Bool:   return boolValue;
+                    case ValueType::Int:    return intValue;
+                    case ValueType::Int64:  return static_cast<juce::int64>(int64Value);
+                    case ValueType::Double: return doubleValue;
+                    case ValueType::String: return juce::String::fromUTF8(text, static_cast<int>(length));
+                    case ValueType::Void:   break;
+                }
+                return {};
+            }
+
+            /** Compares without converting, so unchanged strings don't get copied. */
+            bool Equals(const juce::var &value) const {
+                switch (type) {
+                    case ValueType::Bool:   return value.isBool() && static_cast<bool>(value) == boolValue;
+                    case ValueType::Int:    return value.isInt() && static_cast<int>(value) == intValue;
+                    case ValueType::Int64:  return value.isInt64() && static_cast<juce::int64>(value) == int64Value;
+                    case ValueType::Double: return value.isDouble() && juce::exactlyEqual(static_cast<double>(value), doubleValue);
+                    case ValueType::String: {
+                        if (!value.isString()) return false;
+                        auto string = value.toString(); // shares the string, doesn't copy it
+                        auto utf8 = string.getCharPointer();
+                        return utf8.sizeInBytes() == static_cast<size_t>(length) + 1 && std::memcmp(utf8.getAddress(), text, length) == 0;
+                    }
+                    case ValueType::Void:   return value.isVoid();
+                }
+                return false;
+            }
+        };
+
+        // ====================== writing ======================
+
+        /** ids is an IDMap or an IdTable, anything with a GetTypeFromID that returns an optional index. */
+        template <typename IDs>
+        void WriteID(Writer &writer, const juce::Identifier &id, const IDs &ids) {
+            if (auto type = ids.GetTypeFromID(id)) {
+                writer.Write(IdKind::Indexed);
+                writer.Write(static_cast<uint16_t>(*type));
+                return;
+            }
+
+            auto utf8 = id.getCharPointer();
+            auto length = static_cast<uint16_t>(utf8.sizeInBytes() - 1);
+            writer.Write(IdKind::String);
+            writer.Write(length);
+            writer.WriteBytes(utf8.getAddress(), length);
+        }
+
+        inline bool WriteValue(Writer &writer, const juce::var &value) {
+            if (value.isVoid()) writer.Write(ValueType::Void);
+            else if (value.isBool()) { writer.Write(ValueType::Bool); writer.Write(static_cast<uint8_t>(static_cast<bool>(value))); }
+            else if (value.isInt()) { writer.Write(ValueType::Int); writer.Write(static_cast<int32_t>(static_cast<int>(value))); }
+            else if (value.isInt64()) { writer.Write(ValueType::Int64); writer.Write(static_cast<int64_t>(static_cast<juce::int64>(value))); }
+            else if (value.isDouble()) { writer.Write(ValueType::Double); writer.Write(static_cast<double>(value)); }
+            else if (value.isString()) {
+                auto text = value.toString(); // shares the string, doesn't copy it
+                auto utf8 = text.getCharPointer();
+                auto length = static_cast<uint32_t>(utf8.sizeInBytes() - 1);
+                writer.Write(ValueType::String);
+                writer.Write(length);
+                writer.WriteBytes(utf8.getAddress(), length);
+            }
+            else return false; // arrays, objects and binary blobs aren't supported
+
+            return true;
+        }
+
+        template <typename IDs>
+        bool WriteNode(Writer &writer, const juce::ValueTree &node, const IDs &ids) {
+            const int numProperties = node.getNumProperties();
+            const int numChildren = node.getNumChildren();
+            if (numProperties > 0xffff || numChildren > 0xffff) return false;
+
+            WriteID(writer, node.getType(), ids);
+
+            writer.Write(static_cast<uint16_t>(numProperties));
+            for (int i = 0; i < numProperties; ++i) {
+                auto name = node.getPropertyName(i);
+                WriteID(writer, name, ids);
+                if (!WriteValue(writer, node.getProperty(name))) return false;
+            }
+
+            writer.Write(static_cast<uint16_t>(numChildren));
+            for (int i = 0; i < numChildren; ++i) {
+                if (!WriteNode(writer, node.getChild(i), ids)) return false;
+            }
+            return true;
+        }
+
+        inline void WriteHeader(Writer &writer, uint16_t flags) {
+            writer.Write(magic);
+            writer.Write(version);
+            writer.Write(flags);
+        }
+
+        /** Fills the table with every identifier of the tree. @return false when there are too many. */
+        inline bool CollectIds(const juce::ValueTree &node, IdTable &table) {
+            if (!table.Add(node.getType())) return false;
+            for (int i = 0; i < node.getNumProperties(); ++i)
+                if (!table.Add(node.getPropertyName(i))) return false;
+            for (const auto &child : node)
+                if (!CollectIds(child, table)) return false;
+            return true;
+        }
+
+        /** The body of a stored state: the id table, then the tree indexed into it. */
+        inline bool WriteTableBody(Writer &writer, const juce::ValueTree &root, const IdTable &table) {
+            writer.Write(static_cast<uint16_t>(table.ids.size()));
+            for (const auto &id : table.ids) {
+                auto utf8 = id.getCharPointer();
+                auto length = static_cast<uint16_t>(utf8.sizeInBytes() - 1);
+                writer.Write(length);
+                writer.WriteBytes(utf8.getAddress(), length);
+            }
+            return WriteNode(writer, root, table);
+        }
+
+        // ====================== reading ======================
+
+        inline bool ReadID(Reader &reader, ParsedID &id, std::span<const juce::Identifier> ids) {
+            if (!reader.Read(id.kind)) return false;
+            if (id.kind == IdKind::Indexed) return reader.Read(id.index) && id.index < ids.size();
+            if (id.kind != IdKind::String || !reader.Read(id.length)) return false;
+            id.text = reader.ReadBytes(id.length);
+            return id.text != nullptr;
+        }
+
+        inline bool ReadValue(Reader &reader, ParsedValue &value) {
+            if (!reader.Read(value.type)) return false;
+            switch (value.type) {
+                case ValueType::Void:   return true;
+                case ValueType::Bool: {
+                    uint8_t b = 0;
+                    if (!reader.Read(b)) return false;
+                    value.boolValue = b != 0;
+                    return true;
+                }
+                case ValueType::Int:    return reader.Read(value.intValue);
+                case ValueType::Int64:  return reader.Read(value.int64Value);
+                case ValueType::Double: return reader.Read(value.doubleValue);
+                case ValueType::String:
+                    if (!reader.Read(value.length) || value.length > static_cast<uint32_t>(std::numeric_limits<int>::max())) return false;
+                    value.text = reader.ReadBytes(value.length);
+                    return value.text != nullptr;
+            }
+            return false; // unknown type, probably a newer version
+        }
+
+        /** @return true if the node in the data has exactly the same layout as node. */
+        inline bool NodeMatches(Reader &reader, const juce::ValueTree &node, std::span<const juce::Identifier> ids) {
+            ParsedID id;
+            if (!ReadID(reader, id, ids) || !id.Matches(node.getType(), ids)) return false;
+
+            uint16_t numProperties = 0;
+            if (!reader.Read(numProperties) || numProperties != node.getNumProperties()) return false;
+            for (int i = 0; i < numProperties; ++i) {
+                ParsedValue value;
+                if (!ReadID(reader, id, ids) || !id.Matches(node.getPropertyName(i), ids) || !ReadValue(reader, value)) return false;
+            }
+
+            uint16_t numChildren = 0;
+            if (!reader.Read(numChildren) || numChildren != node.getNumChildren()) return false;
+            for (int i = 0; i < numChildren; ++i) {
+                if (!NodeMatches(reader, node.getChild(i), ids)) return false;
+            }
+            return true;
+        }
+
+        /** Only call this after NodeMatches succeeded on the same data. */
+        inline void ApplyNode(Reader &reader, juce::ValueTree node, std::span<const juce::Identifier> ids, juce::UndoManager *undoManager) {
+            ParsedID id;
+            ReadID(reader, id, ids);
+
+            uint16_t numProperties = 0;
+            reader.Read(numProperties);
+            for (int i = 0; i < numProperties; ++i) {
+                ParsedValue value;
+                ReadID(reader, id, ids);
+                ReadValue(reader, value);
+
+                auto name = node.getPropertyName(i);
+                if (!value.Equals(node.getProperty(name)))
+                    node.setProperty(name, value.ToVar(), undoManager);
+            }
+
+            uint16_t numChildren = 0;
+            reader.Read(numChildren);
+            for (int i = 0; i < numChildren; ++i)
+                ApplyNode(reader, node.getChild(i), ids, undoManager);
+        }
+
+        /** @return The new tree, or an invalid tree if the data was broken. */
+        inline juce::ValueTree BuildNode(Reader &reader, std::span<const juce::Identifier> ids, int depth) {
+            ParsedID id;
+            if (depth > maxDepth || !ReadID(reader, id, ids)) return {};
+            auto type = id.ToIdentifier(ids);
+            if (!type) return {};
+
+            juce::ValueTree node{*type};
+
+            uint16_t numProperties = 0;
+            if (!reader.Read(numProperties)) return {};
+            for (int i = 0; i < numProperties; ++i) {
+                ParsedValue value;
+                if (!ReadID(reader, id, ids) || !ReadValue(reader, value)) return {};
+                auto name = id.ToIdentifier(ids);
+                if (!name) return {};
+                node.setProperty(*name, value.ToVar(), nullptr);
+            }
+
+            uint16_t numChildren = 0;
+            if (!reader.Read(numChildren)) return {};
+            for (int i = 0; i < numChildren; ++i) {
+                auto child = BuildNode(reader, ids, depth + 1);
+                if (!child.isValid()) return {};
+                node.appendChild(child, nullptr);
+            }
+            return node;
+        }
+
+        /** The body of the data, ready to read its tree with ids. Owns whatever had to be decompressed or interned. */
+        struct Body {
+            Reader reader{nullptr, 0};
+            std::span<const juce::Identifier> ids;
+            juce::MemoryBlock inflated;
+            std::vector<juce::Identifier> table;
+        };
+
+        /**
+         * Reads the header, decompresses and reads the id table when the data has them. Uncompressed data without a table doesn't allocate.
+         * @param enumIds What indexed ids refer to when there is no table.
+         * @return false when the data is broken, not a snapshot, or from a newer version.
+         */
+        inline bool OpenBody(const void *data, size_t size, std::span<const juce::Identifier> enumIds, Body &body) {
+            if (data == nullptr) return false;
+            Reader header{data, size};
+            uint32_t dataMagic = 0;
+            uint16_t dataVersion = 0, flags = 0;
+            if (!header.Read(dataMagic) || !header.Read(dataVersion) || !header.Read(flags)) return false;
+            if (dataMagic != magic || dataVersion != version || (flags & ~knownFlags) != 0) return false;
+
+            const char *bytes = static_cast<const char *>(data) + headerSize;
+            size_t numBytes = size - headerSize;
+
+            if ((flags & compressedFlag) != 0) {
+                uint32_t bodySize = 0;
+                if (!header.Read(bodySize)) return false;
+                bytes += sizeof(bodySize);
+                numBytes -= sizeof(bodySize);
+                // zlib can't shrink anything by more than about 1:1032, so bigger claims are broken data
+                if (bodySize / 1032 > numBytes) return false;
+
+                body.inflated.setSize(bodySize);
+                juce::MemoryInputStream source{bytes, numBytes, false};
+                juce::GZIPDecompressorInputStream zlib{&source, false, juce::GZIPDecompressorInputStream::zlibFormat, static_cast<juce::int64>(bodySize)};
+                size_t numRead = 0;
+                while (numRead < bodySize) {
+                    const int chunk = zlib.read(static_cast<char *>(body.inflated.getData()) + numRead, static_cast<int>(std::min<size_t>(bodySize - numRead, 1 << 20)));
+                    if (chunk <= 0) return false;
+                    numRead += static_cast<size_t>(chunk);
+                }
+                bytes = static_cast<const char *>(body.inflated.getData());
+                numBytes = bodySize;
+            }
+
+            body.reader = Reader{bytes, numBytes};
+            body.ids = enumIds;
+            if ((flags & idTableFlag) == 0) return true;
+
+            // every name is interned once here, not once per node
+            uint16_t numIds = 0;
+            if (!body.reader.Read(numIds)) return false;
+            body.table.reserve(numIds);
+            for (uint16_t i = 0; i < numIds; ++i) {
+                uint16_t length = 0;
+                if (!body.reader.Read(length) || length == 0) return false; // identifiers can't be empty
+                auto *text = body.reader.ReadBytes(length);
+                if (text == nullptr) return false;
+                body.table.emplace_back(juce::String::fromUTF8(text, length));
+            }
+            body.ids = body.table;
+            return true;
+        }
+    } // namespace detail
+
+    /** @return true if data starts with a snapshot header, so it should be read from here and not with juce::ValueTree::readFromData. */
+    inline bool IsSnapshot(const void *data, size_t size) {
+        if (data == nullptr || size < headerSize) return false;
+        Reader reader{data, size};
+        uint32_t dataMagic = 0;
+        return reader.Read(dataMagic) && dataMagic == magic;
+    }
+
+    /**
+     * Writes a snapshot of the tree into dest, without allocating. Identifiers that ids knows are stored as their enum index.
+     * @param ids An IDMap, so reading needs the same enum's identifiers.
+     * @param bytesWritten Set to the size of the snapshot, also when it didn't fit, so you know how much to provide.
+     * @return true if the whole snapshot fit in dest. False if it didn't, or if the tree has values that can't be stored.
+     */
+    template <typename IDs>
+    bool Write(const juce::ValueTree &root, const IDs &ids, void *dest, size_t capacity, size_t &bytesWritten) {
+        Writer writer{dest, capacity};
+        detail::WriteHeader(writer, 0);
+
+        bool supported = root.isValid() && detail::WriteNode(writer, root, ids);
+        bytesWritten = writer.written;
+        return supported && !writer.overflowed;
+    }
+
+    /**
+     * Writes the tree with its own id table, so it can be read without knowing any enum. This is what the plugin state is stored as.
+     * @param compress Compresses the body with zlib, when it's big enough and actually gets smaller.
+     * @return false without writing anything if the tree is invalid, or has values or sizes this format can't store.
+     */
+    inline bool WriteToStream(const juce::ValueTree &root, juce::OutputStream &stream, bool compress) {
+        IdTable table;
+        if (!root.isValid() || !detail::CollectIds(root, table)) return false;
+
+        // counts first, then writes into memory of exactly that size
+        Writer counter{nullptr, 0};
+        if (!detail::WriteTableBody(counter, root, table) || counter.written > std::numeric_limits<uint32_t>::max()) return false;
+        juce::MemoryBlock body{counter.written};
+        Writer writer{body.getData(), body.getSize()};
+        detail::WriteTableBody(writer, root, table);
+
+        juce::MemoryOutputStream compressed;
+        if (compress && body.getSize() >= minCompressSize) {
+            {
+                juce::GZIPCompressorOutputStream zlib{compressed};
+                zlib.write(body.getData(), body.getSize());
+            } // flushed when it goes out of scope
+        }
+        const bool isCompressed = compressed.getDataSize() > 0 && compressed.getDataSize() + sizeof(uint32_t) < body.getSize();
+
+        uint8_t header[headerSize + sizeof(uint32_t)];
+        Writer headerWriter{header, sizeof(header)};
+        detail::WriteHeader(headerWriter, static_cast<uint16_t>(idTableFlag | (isCompressed ? compressedFlag : 0)));
+        if (isCompressed) headerWriter.Write(static_cast<uint32_t>(body.getSize()));
+
+        stream.write(header, headerWriter.written);
+        if (isCompressed) stream.write(compressed.getData(), compressed.getDataSize());
+        else stream.write(body.getData(), body.getSize());
+        return true;
+    }
+
+    /**
+     * Restores root from any snapshot: from Write, or from WriteToStream.
+     * Updates the tree in place when its layout (types, property names and children) matches the data, which doesn't allocate
+     * unless string values changed or the data has an id table or is compressed. Otherwise a new tree is built from the data.
+     * @param enumIds The identifiers of the enum the snapshot was written with (IDMap::GetIDs), for data without an id table.
+     * @return true if it was restored. The tree is left untouched when the data is broken or from another version.
+     */
+    inline bool Read(juce::ValueTree &root, std::span<const juce::Identifier> enumIds, const void *data, size_t size, juce::UndoManager *undoManager = nullptr) {
+        detail::Body body;
+        if (!detail::OpenBody(data, size, enumIds, body)) return false;
+
+        // same layout: only update the values
+        Reader matchReader = body.reader;
+        if (root.isValid() && detail::NodeMatches(matchReader, root, body.ids) && matchReader.IsAtEnd()) {
+            detail::ApplyNode(body.reader, root, body.ids, undoManager);
+            return true;
+        }
+
+        auto newRoot = detail::BuildNode(body.reader, body.ids, 0);
+        if (!newRoot.isValid() || !body.reader.IsAtEnd()) return false;
+        root = newRoot;
+        return true;
+    }
+
+    /** Same as Read into a new tree. Safe on any thread. @return The tree, or an invalid tree when the data is broken. */
+    inline juce::ValueTree ReadTree(const void *data, size_t size, std::span<const juce::Identifier> enumIds = {}) {
+        juce::ValueTree root;
+        Read(root, enumIds, data, size);
+        return root;
+    }
+
+} // namespace
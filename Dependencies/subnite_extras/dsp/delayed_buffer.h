@@ -13,24 +13,95 @@
 
 namespace subnite
 {
+	// Delays audio by a fixed amount of samples, with blocks of any size up to the max block size.
+	// All memory is allocated when constructing or in Prepare, so filling and reading it is realtime safe.
+	template <typename bufferType = float>
 	class DelayedBuffer
 	{
 	private:
-		juce::AudioBuffer<float> buffer;
-		juce::AudioBuffer<float> overflowBuffer;
+		juce::AudioBuffer<bufferType> ring; // latencySize + maxBlockSize samples, written circularly
+		int numChannels = 0;
+		int maxBlockSize = 0;
+		int latencySize = 0;
+		int writePosition = 0;
+		int lastBlockSize = 0;
 
-		int numChannels;
-		int blockSize;
-		int latencySize;
-		int samplesAdded = 0;
+		// copies numSamples from the ring, starting at position (wrapping around), into dest
+		void CopyFromRing(juce::AudioBuffer<bufferType>& dest, int channel, int position, int numSamples) const
+		{
+			const int firstPart = std::min(numSamples, ring.getNumSamples() - position);
+			dest.copyFrom(channel, 0, ring, channel, position, firstPart);
+			if (firstPart < numSamples)
+				dest.copyFrom(channel, firstPart, ring, channel, 0, numSamples - firstPart);
+		}
 
-		void FillBuffersWithZero();
 	public:
-		DelayedBuffer(const int& numChannels, const int& blockSize, const int& samplesLatencyAmount);
+		DelayedBuffer() = default;
+		DelayedBuffer(const int& inChannels, const int& maxNumSamples, const int& samplesLatencyAmount)
+		{
+			Prepare(inChannels, maxNumSamples, samplesLatencyAmount);
+		}
 
-		void FillBuffer(juce::AudioBuffer<float>& inputBuffer);
+		// allocates, keeps the memory when it's big enough already. Starts out silent.
+		void Prepare(int inChannels, int maxNumSamples, int samplesLatencyAmount)
+		{
+			jassert(inChannels >= 0 && maxNumSamples >= 0 && samplesLatencyAmount >= 0);
+			numChannels = inChannels;
+			maxBlockSize = maxNumSamples;
+			latencySize = samplesLatencyAmount;
 
-		const juce::AudioBuffer<float>* GetBuffer() const;
-		void SetBufferToDelayedBuffer(juce::AudioBuffer<float>& outputBuffer) const;
+			// keepExistingContent = false, clearExtraSpace = true, avoidReallocating = true
+			ring.setSize(numChannels, latencySize + maxBlockSize, false, true, true);
+			Reset();
+		}
+
+		void Reset()
+		{
+			ring.clear();
+			writePosition = 0;
+			lastBlockSize = 0;
+		}
+
+		int GetLatency() const { return latencySize; }
+		int GetMaxBlockSize() const { return maxBlockSize; }
+
+		// pushes a block into the delay, can't be longer than the max block size
+		void FillBuffer(const juce::AudioBuffer<bufferType>& inputBuffer)
+		{
+			const int numSamples = inputBuffer.getNumSamples();
+			jassert(numSamples <= maxBlockSize);
+			const int channels = std::min(numChannels, inputBuffer.getNumChannels());
+			const int firstPart = std::min(numSamples, ring.getNumSamples() - writePosition);
+
+			for (int channel = 0; channel < channels; channel++)
+			{
+				ring.copyFrom(channel, writePosition, inputBuffer, channel, 0, firstPart);
+				if (firstPart < numSamples)
+					ring.copyFrom(channel, 0, inputBuffer, channel, firstPart, numSamples - firstPart);
+			}
+
+			writePosition = (writePosition + numSamples) % std::max(1, ring.getNumSamples());
+			lastBlockSize = numSamples;
+		}
+
+		// writes the last filled block, latency samples late, into outputBuffer. outputBuffer can be the one that was filled.
+		void SetBufferToDelayedBuffer(juce::AudioBuffer<bufferType>& outputBuffer) const
+		{
+			const int size = ring.getNumSamples();
+			if (size == 0) return;
+			const int readPosition = ((writePosition - lastBlockSize - latencySize) % size + size) % size;
+			const int channels = std::min(numChannels, outputBuffer.getNumChannels());
+
+			for (int channel = 0; channel < channels; channel++)
+				CopyFromRing(outputBuffer, channel, readPosition, std::min(lastBlockSize, outputBuffer.getNumSamples()));
+		}
+
+		// delays buffer in place
+		void Process(juce::AudioBuffer<bufferType>& buffer)
+		{
+			if (latencySize == 0) return; // nothing to do
+			FillBuffer(buffer);
+			SetBufferToDelayedBuffer(buffer);
+		}
 	};
 }
@@ -25,6 +25,8 @@ template <typename T>
 subnite::Slider<T>::~Slider(){
     // maybe make sure that the mouse is normal
     setMouseCursor(juce::MouseCursor::NormalCursor);
+    stopTimer();
+    if (isInGesture) parameter->EndGesture();
     updateValueTree();
 }
 
@@ -67,6 +69,7 @@ void subnite::Slider<T>::setValue(T newValue) {
     displayedValue = newValue;
 
     normalizedRawValue = (newValue-minValue) / static_cast<double>(maxValue - minValue);
+    updateParameter();
     onValueChanged(displayedValue);
 }
 
@@ -103,7 +106,7 @@ void subnite::Slider<T>::getFromValueTree() {
  */
 template <typename T>
 void subnite::Slider<T>::updateValueTree() {
-    if (vTree == nullptr) return;
+    if (vTree == nullptr || parameter != nullptr) return; // a bound parameter writes its own tree
 
     juce::ValueTree slider{sliderTreeUniqueID};
 
@@ -169,6 +172,10 @@ template <typename T>
 void subnite::Slider<T>::mouseDown(const juce::MouseEvent& e) {
     if (e.mods.isLeftButtonDown()){
         setMouseCursor(juce::MouseCursor::NoCursor);
+        if (parameter != nullptr && !isInGesture) {
+            parameter->BeginGesture();
+            isInGesture = true;
+        }
     }
     // right click change the value from text.
 }
@@ -182,6 +189,10 @@ void subnite::Slider<T>::mouseUp(const juce::MouseEvent& e) {
 
     updateValueTree();
     if (!updateTreeOnDrag) onValueChanged(displayedValue);
+    if (isInGesture) {
+        parameter->EndGesture();
+        isInGesture = false;
+    }
 }
 
 template <typename T>
@@ -196,6 +207,7 @@ void subnite::Slider<T>::mouseDrag(const juce::MouseEvent& e) {
 
         lastDragOffset = offset;
         updateDisplayedValueChecked(updateTreeOnDrag);
+        updateParameter();
         repaint();
 
         if (offset.getDistanceSquaredFrom({0,0}) > 50) {
@@ -208,7 +220,10 @@ void subnite::Slider<T>::mouseDrag(const juce::MouseEvent& e) {
 template <typename T>
 void subnite::Slider<T>::mouseDoubleClick(const juce::MouseEvent& e) {
     if (e.mods.isLeftButtonDown()){
+        const bool startsGesture = parameter != nullptr && !isInGesture;
+        if (startsGesture) parameter->BeginGesture();
         setValue(defaultValue);
+        if (startsGesture) parameter->EndGesture();
         repaint();
     }
 
@@ -230,6 +245,39 @@ juce::Identifier rawNormalizedID, juce::Identifier displayID, juce::Identifier m
     getFromValueTree();
 }
 
+template <typename T>
+void subnite::Slider<T>::bindParameter(SliderParameter* parameterToBind) {
+    if (isInGesture) parameter->EndGesture();
+    isInGesture = false;
+    parameter = parameterToBind;
+
+    if (parameter == nullptr) {
+        stopTimer();
+        return;
+    }
+
+    normalizedRawValue = std::clamp(parameter->GetNormalized(), 0.0, 1.0);
+    updateDisplayedValueChecked(false);
+    repaint();
+    startTimerHz(30);
+}
+
+template <typename T>
+void subnite::Slider<T>::updateParameter() {
+    if (parameter != nullptr) parameter->SetNormalized(normalizedRawValue);
+}
+
+template <typename T>
+void subnite::Slider<T>::timerCallback() {
+    if (isInGesture) return; // the drag is the newest value
+
+    const double hostValue = std::clamp(parameter->GetNormalized(), 0.0, 1.0);
+    if (juce::exactlyEqual(hostValue, normalizedRawValue)) return;
+
+    normalizedRawValue = hostValue;
+    updateDisplayedValueChecked(false);
+    repaint();
+}
 
 
 
@@ -4,11 +4,12 @@
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <juce_graphics/juce_graphics.h>
 #include "../common/value_tree_manager.h"
+#include "slider_parameter.h"
 
 namespace subnite {
 
 template<typename T>
-class Slider : public juce::Component {
+class Slider : public juce::Component, private juce::Timer {
 public:
     /** Sets up the slider values.
         @param minValue The minimum display value.
@@ -107,6 +108,13 @@ public:
     /** Sets up the value tree, and updates this component from its values. */
     void setValueTree(subnite::vt::ValueTreeBase* parentTree, juce::Identifier uniqueSliderTreeID, juce::Identifier rawNormalizedValueID, juce::Identifier displayValueID, juce::Identifier minValueID, juce::Identifier maxValueID);
 
+    /** Binds the slider to a host parameter, which then owns the value instead of the slider's own tree.
+
+        Drags are sent as gestures, and host automation moves the slider. The min, max and normalizedToDisplayed should match the parameter's range.
+        @param parameterToBind Has to outlive the slider, nullptr unbinds it.
+    */
+    void bindParameter(SliderParameter* parameterToBind);
+
     // optionals
     /** If the value should be displayed when you hover over the slider. */
     bool displayValueOnHover = true;
@@ -125,6 +133,11 @@ private:
     juce::Identifier sliderTreeUniqueID{"undefined"};
     juce::Identifier rawNormalizedValueID{"undefined"}, displayValueID{"undefined"}, minValueID{"undefined"},  maxValueID{"undefined"};
 
+    /** The host parameter this slider is bound to, if any. @see bindParameter */
+    SliderParameter* parameter = nullptr;
+    /** If a gesture was started on mouseDown. */
+    bool isInGesture = false;
+
     std::string prefix = "";
     std::string postfix = "";
 
@@ -136,6 +149,11 @@ private:
     /** Updates the displayed value from the normalized value. @param updateTree Calls onValueChanged() if set to true. */
     void updateDisplayedValueChecked(bool updateTree = true);
 
+    /** Sends the normalized value to the bound parameter, if there is one. */
+    void updateParameter();
+    /** Follows changes of the bound parameter that didn't come from this slider, like host automation. */
+    void timerCallback() override;
+
     /** Draws the slider. */
     void paint(juce::Graphics &g) override;
 
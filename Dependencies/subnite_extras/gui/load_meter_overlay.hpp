@@ -0,0 +1,83 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <juce_graphics/juce_graphics.h>
+#include "../common/load_meter.hpp"
+
+namespace subnite {
+
+/** Draws the recent block loads of a LoadMeter as a graph, with the average, peak and overrun count on top.
+
+    Polls the meter on a timer, so it never touches the audio thread. Doesn't take mouse clicks, so it can sit on top of anything.
+*/
+class LoadMeterOverlay : public juce::Component, private juce::Timer {
+public:
+    explicit LoadMeterOverlay(const LoadMeter& meterToShow, int refreshRateHz = 15);
+    ~LoadMeterOverlay() override;
+
+    void paint(juce::Graphics& g) override;
+
+private:
+    void timerCallback() override;
+
+    const LoadMeter& meter;
+    LoadMeter::Stats stats{};
+    std::array<float, LoadMeter::historySize> recentLoads{};
+    size_t numRecentLoads = 0;
+};
+
+// header only, so the static library build doesn't need SubniteExtras linked
+inline LoadMeterOverlay::LoadMeterOverlay(const LoadMeter& meterToShow, int refreshRateHz)
+    : meter(meterToShow)
+{
+    setInterceptsMouseClicks(false, false);
+    startTimerHz(refreshRateHz);
+}
+
+inline LoadMeterOverlay::~LoadMeterOverlay() {
+    stopTimer();
+}
+
+inline void LoadMeterOverlay::timerCallback() {
+    stats = meter.GetStats();
+    numRecentLoads = meter.GetRecentLoads(recentLoads.data(), recentLoads.size());
+    repaint();
+}
+
+inline void LoadMeterOverlay::paint(juce::Graphics& g) {
+    auto bounds = getLocalBounds().toFloat();
+    g.setColour(juce::Colours::black.withAlpha(0.6f));
+    g.fillRoundedRectangle(bounds, 4.f);
+
+    auto textArea = bounds.removeFromTop(16.f);
+    auto graphArea = bounds.reduced(4.f);
+
+    // the graph goes up to twice the budget, with a line where the deadline is
+    constexpr float maxShownLoad = 2.f;
+    auto loadToY = [&graphArea](float load) {
+        return graphArea.getBottom() - graphArea.getHeight() * std::min(load, maxShownLoad) / maxShownLoad;
+    };
+
+    g.setColour(juce::Colours::red.withAlpha(0.5f));
+    g.drawHorizontalLine(juce::roundToInt(loadToY(1.f)), graphArea.getX(), graphArea.getRight());
+
+    if (numRecentLoads > 1) {
+        juce::Path graph;
+        const float step = graphArea.getWidth() / static_cast<float>(numRecentLoads - 1);
+        graph.startNewSubPath(graphArea.getX(), loadToY(recentLoads[0]));
+        for (size_t i = 1; i < numRecentLoads; ++i)
+            graph.lineTo(graphArea.getX() + step * static_cast<float>(i), loadToY(recentLoads[i]));
+
+        g.setColour(stats.peakLoad > 1.f ? juce::Colours::orange : juce::Colours::limegreen);
+        g.strokePath(graph, juce::PathStrokeType{1.f});
+    }
+
+    g.setColour(juce::Colours::white);
+    g.setFont(12.f);
+    g.drawText(juce::String::formatted("CPU %.1f%%  peak %.1f%%  overruns %llu",
+            stats.averageLoad * 100.f, stats.peakLoad * 100.f, static_cast<unsigned long long>(stats.numOverruns)),
+        textArea.reduced(4.f, 0.f), juce::Justification::centredLeft, false);
+}
+
+} // namespace
@@ -0,0 +1,24 @@
+#pragma once
+
+namespace subnite {
+
+/** A host parameter as a Slider sees it, so the gui doesn't depend on juce_audio_processors.
+
+    Values are normalized [0.0 : 1.0], the same as the slider's normalized value.
+    Everything is called on the message thread. @see Slider::bindParameter
+*/
+class SliderParameter {
+public:
+    virtual ~SliderParameter() = default;
+
+    /** @return The current normalized value, also when the host changed it. */
+    virtual double GetNormalized() const = 0;
+    /** Called on mouse down, before the first SetNormalized of a drag. */
+    virtual void BeginGesture() = 0;
+    /** Called for every change, the host may be told about them in batches. */
+    virtual void SetNormalized(double normalizedValue) = 0;
+    /** Called on mouse up, after the last SetNormalized of a drag. */
+    virtual void EndGesture() = 0;
+};
+
+} // namespace
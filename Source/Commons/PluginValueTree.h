@@ -1,5 +1,6 @@
 #pragma once
 #include "subnite_extras/common/value_tree_manager.h"
+#include "subnite_extras/common/value_tree_snapshot.h"
 #include <juce_core/juce_core.h>
 
 namespace myplugin::vt {
@@ -17,31 +18,21 @@ enum class Property {
 class ValueTree : public subnite::vt::ValueTreeBase, public subnite::vt::IDMap<Property> {
 public:
     ValueTree()
-    : subnite::vt::ValueTreeBase(), subnite::vt::IDMap<Property>()
-    {
-        SetupMap();
-    };
+    : subnite::vt::ValueTreeBase(), subnite::vt::IDMap<Property>(names)
+    {};
     ~ValueTree(){};
 
-    template <typename PropertyEnum>
-    juce::Identifier GetIDUnwrapped(PropertyEnum id) const {
-        return GetIDFromType(id).value_or(juce::Identifier{"undefined"});
+    const juce::Identifier& GetIDUnwrapped(Property id) const {
+        return GetID(id);
     }
 
-    void SetupMap() override {
-        using p = Property;
-        using id = juce::Identifier;
+    static constexpr auto names = subnite::vt::MakeIDNames<Property>({
+        // trees
+        {Property::T_ROOT, "MyPluginRoot"},
 
-        #pragma region trees
-        map[p::T_ROOT] = id{"MyPluginRoot"};
-
-        #pragma endregion trees
-
-        #pragma region properties
-        map[p::P_POWER] = id{"power"};
-
-        #pragma endregion properties
-    }
+        // properties
+        {Property::P_POWER, "power"},
+    });
 
     // makes the default tree
     void Create() override {
@@ -54,6 +45,22 @@ public:
         // add properties
         vtRoot.setProperty(GetIDUnwrapped(prop::P_POWER), {0.69}, &undoManager);
     }
+
+    // writes a compact binary snapshot into dest without allocating. bytesWritten is the needed size, also when it didn't fit.
+    bool WriteSnapshot(void* dest, size_t capacity, size_t& bytesWritten) const {
+        return subnite::vt::snapshot::Write(vtRoot, *this, dest, capacity, bytesWritten);
+    }
+
+    // restores a snapshot from WriteSnapshot or the plugin state, in place when the tree layout didn't change.
+    bool ReadSnapshot(const void* data, size_t sizeInBytes) {
+        return subnite::vt::snapshot::Read(vtRoot, GetIDs(), data, sizeInBytes);
+    }
+
+    // ValueTreeBase::ReadTree, which also reads snapshots from WriteSnapshot. Safe on any thread.
+    static juce::ValueTree ReadTree(const void* data, size_t size) {
+        static const subnite::vt::IDMap<Property> ids{names};
+        return subnite::vt::ValueTreeBase::ReadTree(data, size, ids.GetIDs());
+    }
 };
 
 
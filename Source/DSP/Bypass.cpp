@@ -0,0 +1,28 @@
+#include "Bypass.h"
+
+//==============================================================================
+
+void BypassEngine::Prepare(double sampleRate, int numChannels, int newMaxBlockSize, int latencySamples, double fadeSeconds) {
+    maxBlockSize = newMaxBlockSize;
+    latency = latencySamples;
+
+    floatDelay.Prepare(numChannels, maxBlockSize, latency);
+    doubleDelay.Prepare(numChannels, maxBlockSize, latency);
+    floatDry.setSize(numChannels, maxBlockSize, false, true, true);
+    doubleDry.setSize(numChannels, maxBlockSize, false, true, true);
+    ramp.resize(static_cast<size_t>(maxBlockSize));
+
+    // the delay starts out silent, so jump straight to where we're supposed to be
+    dryGain.reset(sampleRate, fadeSeconds);
+    dryGain.setCurrentAndTargetValue(isBypassed ? 1.f : 0.f);
+    state = isBypassed ? State::Bypassed : State::Active;
+}
+
+bool BypassEngine::BeginBlock(bool shouldBeBypassed) {
+    if (shouldBeBypassed == isBypassed) return false;
+    const bool wasFullyBypassed = state == State::Bypassed;
+    isBypassed = shouldBeBypassed;
+    dryGain.setTargetValue(isBypassed ? 1.f : 0.f);
+    state = State::Fading;
+    return wasFullyBypassed;
+}
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    Latency compensated bypass. While bypassed the dry signal goes through a
+    delay matching the reported latency, and switching crossfades between the
+    two so nothing jumps or clicks. Nothing allocates after Prepare.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "subnite_extras/dsp/delayed_buffer.h"
+#include <vector>
+
+//==============================================================================
+
+class BypassEngine {
+public:
+    BypassEngine() = default;
+
+    // allocates, call it from prepareToPlay after the latency is known
+    void Prepare(double sampleRate, int numChannels, int maxBlockSize, int latencySamples, double fadeSeconds = 0.01);
+
+    // audio thread, once at the start of every block.
+    // @return true when coming out of full bypass. The processing still holds the audio from before the bypass then,
+    //         reset it before the fade in or that's what gets faded in.
+    bool BeginBlock(bool shouldBeBypassed);
+
+    // both before processing, on every chunk (max GetMaxBlockSize() samples). Feeds the dry signal into the delay, and
+    // when fully bypassed delays the chunk in place, which is all a bypassed block costs.
+    // @return true if the chunk has to be processed: when active, or while still fading. A fade can end partway through a block,
+    //         so this is decided per chunk.
+    template <typename FloatType>
+    bool PushDry(juce::AudioBuffer<FloatType>& chunk);
+    // after processing, fades between the processed chunk and the delayed dry signal
+    template <typename FloatType>
+    void EndChunk(juce::AudioBuffer<FloatType>& chunk);
+
+    int GetMaxBlockSize() const { return maxBlockSize; }
+
+private:
+    enum class State { Active, Bypassed, Fading };
+
+    template <typename FloatType>
+    subnite::DelayedBuffer<FloatType>& GetDelay() {
+        if constexpr (std::is_same_v<FloatType, float>) return floatDelay;
+        else return doubleDelay;
+    }
+    template <typename FloatType>
+    juce::AudioBuffer<FloatType>& GetDry() {
+        if constexpr (std::is_same_v<FloatType, float>) return floatDry;
+        else return doubleDry;
+    }
+
+    State state = State::Active;
+    bool isBypassed = false;
+    int maxBlockSize = 0;
+    int latency = 0;
+
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> dryGain; // 0 = processed, 1 = bypassed
+    std::vector<float> ramp; // the dry gain per sample of the current chunk
+
+    subnite::DelayedBuffer<float> floatDelay;
+    subnite::DelayedBuffer<double> doubleDelay;
+    // the delayed dry chunk while fading
+    juce::AudioBuffer<float> floatDry;
+    juce::AudioBuffer<double> doubleDry;
+};
+
+//==============================================================================
+
+template <typename FloatType>
+bool BypassEngine::PushDry(juce::AudioBuffer<FloatType>& chunk) {
+    auto& delay = GetDelay<FloatType>();
+    jassert(chunk.getNumSamples() <= maxBlockSize);
+
+    switch (state) {
+    case State::Bypassed:
+        delay.Process(chunk); // in place, doesn't even copy without latency
+        return false;
+    case State::Active:
+        // keep the history going, so bypassing later has the right dry signal right away. Without latency the input is the history.
+        if (latency > 0) delay.FillBuffer(chunk);
+        return true;
+    case State::Fading: {
+        auto& dry = GetDry<FloatType>();
+        juce::AudioBuffer<FloatType> dryChunk{dry.getArrayOfWritePointers(), std::min(dry.getNumChannels(), chunk.getNumChannels()), chunk.getNumSamples()};
+        if (latency > 0) {
+            delay.FillBuffer(chunk);
+            delay.SetBufferToDelayedBuffer(dryChunk);
+        } else {
+            for (int channel = 0; channel < dryChunk.getNumChannels(); ++channel)
+                dryChunk.copyFrom(channel, 0, chunk, channel, 0, chunk.getNumSamples());
+        }
+        return true;
+    }
+    }
+    return true;
+}
+
+template <typename FloatType>
+void BypassEngine::EndChunk(juce::AudioBuffer<FloatType>& chunk) {
+    if (state != State::Fading) return; // active leaves the processed signal, bypassed was delayed in PushDry
+
+    const int numSamples = chunk.getNumSamples();
+    for (int i = 0; i < numSamples; ++i)
+        ramp[static_cast<size_t>(i)] = dryGain.getNextValue();
+
+    const auto& dry = GetDry<FloatType>();
+    const int channels = std::min(dry.getNumChannels(), chunk.getNumChannels());
+    for (int channel = 0; channel < channels; ++channel) {
+        FloatType* wet = chunk.getWritePointer(channel);
+        const FloatType* delayedDry = dry.getReadPointer(channel);
+        for (int i = 0; i < numSamples; ++i) {
+            const auto gain = static_cast<FloatType>(ramp[static_cast<size_t>(i)]);
+            wet[i] += gain * (delayedDry[i] - wet[i]);
+        }
+    }
+
+    if (!dryGain.isSmoothing())
+        state = isBypassed ? State::Bypassed : State::Active;
+}
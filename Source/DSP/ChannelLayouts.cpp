@@ -0,0 +1,23 @@
+#include "ChannelLayouts.h"
+#include <cmath>
+
+//==============================================================================
+
+juce::AudioChannelSet myplugin::layouts::ForChannelCount(size_t numChannels) {
+    if (numChannels == 0) return juce::AudioChannelSet::disabled();
+
+    // full sphere ambisonics has (order + 1)^2 channels. Below 9 channels the speaker layouts are more likely.
+    const auto order = static_cast<int>(std::lround(std::sqrt(static_cast<double>(numChannels)))) - 1;
+    if (numChannels >= 9 && static_cast<size_t>((order + 1) * (order + 1)) == numChannels)
+        return juce::AudioChannelSet::ambisonic(order);
+
+    if (numChannels == 10) return juce::AudioChannelSet::create7point1point2();
+    if (numChannels == 12) return juce::AudioChannelSet::create7point1point4();
+
+    // mono, stereo, LCR, quad, 5.0, 5.1, 7.0, 7.1, and discrete channels for the rest
+    return juce::AudioChannelSet::canonicalChannelSet(static_cast<int>(numChannels));
+}
+
+bool myplugin::layouts::IsSupported(const juce::AudioChannelSet& channelSet) {
+    return !channelSet.isDisabled() && static_cast<size_t>(channelSet.size()) <= maxChannels;
+}
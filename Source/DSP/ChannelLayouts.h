@@ -0,0 +1,25 @@
+/*
+  ==============================================================================
+
+    Which bus layouts the processor accepts, and which one to use when only a
+    channel count is known (the dyn_lib and offline hosts).
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_audio_basics/juce_audio_basics.h>
+
+namespace myplugin::layouts {
+
+inline constexpr size_t maxChannels = 64; // 7th order ambisonics
+
+// channel counts that get their own processing kernel, everything else runs the generic one
+inline constexpr size_t dynamicChannelCount = 0;
+
+// common surround layouts for their channel count (6 = 5.1, 12 = 7.1.4, 9/16/25... = ambisonics), discrete channels otherwise
+juce::AudioChannelSet ForChannelCount(size_t numChannels);
+
+bool IsSupported(const juce::AudioChannelSet& channelSet);
+
+} // namespace myplugin::layouts
@@ -0,0 +1,140 @@
+#include "ChannelWorkers.h"
+#if JUCE_INTEL
+#include <immintrin.h>
+#endif
+
+//==============================================================================
+
+namespace {
+
+constexpr uint64_t indexMask = 0xFFFF;
+
+size_t GetIndex(uint64_t state) { return static_cast<size_t>(state & indexMask); }
+size_t GetNumTasks(uint64_t state) { return static_cast<size_t>((state >> 16) & indexMask); }
+uint64_t GetGeneration(uint64_t state) { return state >> 32; }
+
+constexpr double costSmoothing = 0.1; // weight of the newest measurement in the moving averages
+constexpr double initialWakeLatencySeconds = 20e-6; // until the first parallel block measures it
+// every serial block forgets a little of the measured wake latency, so a pool that was too late once gets tried again
+constexpr double wakeLatencyDecay = 0.999;
+
+// tells the core it's spinning, so it doesn't starve its hyperthread sibling or speculate through the loop
+void PauseWhileSpinning() {
+#if JUCE_INTEL
+    _mm_pause();
+#elif JUCE_ARM && (defined(__GNUC__) || defined(__clang__))
+    __asm__ __volatile__("yield");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+} // namespace
+
+class ChannelWorkerPool::Worker : public juce::Thread {
+public:
+    explicit Worker(ChannelWorkerPool& owner) : juce::Thread("Channel worker"), pool(owner) {}
+
+    void run() override {
+        while (!threadShouldExit()) {
+            pool.wake.acquire();
+            if (threadShouldExit()) return;
+            pool.Participate(true);
+        }
+    }
+
+private:
+    ChannelWorkerPool& pool;
+};
+
+ChannelWorkerPool::ChannelWorkerPool() = default; // Worker is only complete in here
+
+ChannelWorkerPool::~ChannelWorkerPool() {
+    Prepare(0, 0.0, 0);
+}
+
+void ChannelWorkerPool::Prepare(size_t numWorkers, double sampleRate, int maxBlockSize) {
+    ticksPerSample = 0.0;
+    wakeLatencyTicks = initialWakeLatencySeconds * static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+    if (numWorkers == workers.size()) return;
+
+    // restart them all, nothing is processing while preparing
+    for (auto& worker : workers) worker->signalThreadShouldExit();
+    wake.release(static_cast<std::ptrdiff_t>(workers.size()));
+    for (auto& worker : workers) worker->stopThread(1000);
+    workers.clear();
+    while (wake.try_acquire()) {} // tokens nobody picked up
+
+    // realtime threads, with the block's duration as a hint so the scheduler knows the deadline
+    auto options = juce::Thread::RealtimeOptions{}.withApproximateAudioProcessingTime(std::max(maxBlockSize, 1), sampleRate > 0.0 ? sampleRate : 48000.0);
+    for (size_t i = 0; i < numWorkers; ++i) {
+        workers.push_back(std::make_unique<Worker>(*this));
+        if (!workers.back()->startRealtimeThread(options))
+            workers.back()->startThread(juce::Thread::Priority::highest); // no realtime permissions, best we can do
+    }
+}
+
+bool ChannelWorkerPool::ShouldRunInParallel(size_t numTasks, size_t numSamples) const {
+    if (workers.empty() || numTasks < 2 || numTasks > maxTasks || ticksPerSample <= 0.0) return false;
+
+    // the workers start wakeLatencyTicks late and share what the audio thread hasn't done by then,
+    // so spreading out only pays off when a good part of the block is still left at that point
+    const double serialTicks = ticksPerSample * static_cast<double>(numTasks * numSamples);
+    return serialTicks > 2.0 * wakeLatencyTicks;
+}
+
+void ChannelWorkerPool::MeasureCost(juce::int64 ticks, size_t numTasks, size_t numSamples) {
+    const double measured = static_cast<double>(ticks) / static_cast<double>(std::max<size_t>(numTasks * numSamples, 1));
+    ticksPerSample = ticksPerSample <= 0.0 ? measured : ticksPerSample + costSmoothing * (measured - ticksPerSample);
+    wakeLatencyTicks *= wakeLatencyDecay;
+}
+
+void ChannelWorkerPool::Run(size_t numTasks, size_t numSamples, Task task, void* context) {
+    batchTask = task;
+    batchContext = context;
+    tasksLeft.store(numTasks, std::memory_order_relaxed);
+    batchTaskTicks.store(0, std::memory_order_relaxed);
+    batchFirstWorkerTicks.store(0, std::memory_order_relaxed);
+    batchOpenedTicks = juce::Time::getHighResolutionTicks();
+
+    // opens the batch, the task and context are visible to whoever claims from it
+    const uint64_t generation = GetGeneration(batchState.load(std::memory_order_relaxed)) + 1;
+    batchState.store((generation << 32) | (static_cast<uint64_t>(numTasks) << 16), std::memory_order_release);
+    wake.release(static_cast<std::ptrdiff_t>(std::min(workers.size(), numTasks - 1)));
+
+    // takes every task no worker has claimed yet, so workers that haven't started by now don't get any
+    Participate(false);
+
+    // everything is claimed now, only wait for the tasks still running on workers. That's at most one task each,
+    // too short to be worth sleeping (and waking up again) on the audio thread.
+    while (tasksLeft.load(std::memory_order_acquire) != 0)
+        PauseWhileSpinning();
+
+    MeasureCost(batchTaskTicks.load(std::memory_order_relaxed), numTasks, numSamples);
+    // when no worker made it in time they're at least this late
+    const auto firstWorker = batchFirstWorkerTicks.load(std::memory_order_relaxed);
+    const auto latency = firstWorker != 0 ? firstWorker : juce::Time::getHighResolutionTicks() - batchOpenedTicks;
+    wakeLatencyTicks += costSmoothing * (static_cast<double>(latency) - wakeLatencyTicks);
+}
+
+void ChannelWorkerPool::Participate(bool isWorker) {
+    bool claimedAny = false;
+    uint64_t state = batchState.load(std::memory_order_acquire);
+    while (GetIndex(state) < GetNumTasks(state)) {
+        if (!batchState.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            continue; // someone else claimed it, state is fresh again
+
+        // claimed, so the batch can't finish (and its task can't change) before this is done
+        const auto start = juce::Time::getHighResolutionTicks();
+        if (isWorker && !claimedAny) {
+            juce::int64 none = 0; // only the first worker's start counts
+            batchFirstWorkerTicks.compare_exchange_strong(none, std::max<juce::int64>(start - batchOpenedTicks, 1), std::memory_order_relaxed);
+        }
+        claimedAny = true;
+
+        batchTask(batchContext, GetIndex(state));
+        batchTaskTicks.fetch_add(juce::Time::getHighResolutionTicks() - start, std::memory_order_relaxed);
+        tasksLeft.fetch_sub(1, std::memory_order_acq_rel);
+        state = batchState.load(std::memory_order_acquire);
+    }
+}
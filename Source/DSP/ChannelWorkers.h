@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    Optional realtime worker threads for independent per channel (or per
+    channel group) work inside processBlock. Off by default.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <memory>
+#include <semaphore>
+#include <vector>
+
+//==============================================================================
+
+// The audio thread takes part in every batch and steals whatever the workers haven't claimed yet,
+// so it only ever waits for tasks that are already running. A late or descheduled worker can't hold the block up.
+// Whether a block is worth spreading out is measured, not configured: the pool keeps track of what a channel sample
+// costs and how late the workers start, and only wakes them when they'd take more work off the audio thread than they're late.
+class ChannelWorkerPool {
+public:
+    using Task = void (*)(void* context, size_t index);
+    static constexpr size_t maxTasks = 0xFFFF;
+
+    ChannelWorkerPool();
+    ~ChannelWorkerPool();
+
+    // message thread or prepareToPlay. 0 workers turns it off. Forgets the measured costs, the DSP behind them may have changed.
+    void Prepare(size_t numWorkers, double sampleRate, int maxBlockSize);
+
+    // audio thread. Calls perChannel(channel) for every channel, spread over the workers when the block is big enough.
+    // Returns when every call is done. perChannel must not touch other channels' data.
+    template <typename Fn>
+    void ForEachChannel(size_t numChannels, size_t numSamples, Fn&& perChannel);
+
+    // audio thread. True when the work the workers would take off the audio thread costs more than the time they take to start.
+    bool ShouldRunInParallel(size_t numTasks, size_t numSamples) const;
+    size_t GetNumWorkers() const { return workers.size(); }
+
+private:
+    class Worker;
+
+    // audio thread
+    void Run(size_t numTasks, size_t numSamples, Task task, void* context);
+    // everyone, claims and runs tasks of the current batch until there are none left
+    void Participate(bool isWorker);
+    // audio thread, with the ticks numTasks * numSamples channel samples took when run one after the other
+    void MeasureCost(juce::int64 ticks, size_t numTasks, size_t numSamples);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::counting_semaphore<maxTasks> wake{0};
+
+    // audio thread only, moving averages in high resolution ticks. Unmeasured (0) cost runs serially to measure it.
+    double ticksPerSample = 0.0;
+    double wakeLatencyTicks = 0.0;
+
+    // generation (32 bits) | number of tasks (16 bits) | next index (16 bits). Claiming is a CAS on all of it,
+    // so a worker waking up late can never claim a task of a batch that has moved on.
+    alignas(64) std::atomic<uint64_t> batchState{0};
+    alignas(64) std::atomic<size_t> tasksLeft{0};
+    // time spent in the tasks of the batch, and how long after opening it the first worker claimed one (0 if none did)
+    alignas(64) std::atomic<juce::int64> batchTaskTicks{0};
+    std::atomic<juce::int64> batchFirstWorkerTicks{0};
+    // only written by the audio thread while no task of the batch is claimable
+    Task batchTask = nullptr;
+    void* batchContext = nullptr;
+    juce::int64 batchOpenedTicks = 0;
+};
+
+//==============================================================================
+
+template <typename Fn>
+void ChannelWorkerPool::ForEachChannel(size_t numChannels, size_t numSamples, Fn&& perChannel) {
+    if (!ShouldRunInParallel(numChannels, numSamples)) {
+        const auto start = workers.empty() ? 0 : juce::Time::getHighResolutionTicks();
+        for (size_t channel = 0; channel < numChannels; ++channel) perChannel(channel);
+        if (!workers.empty()) MeasureCost(juce::Time::getHighResolutionTicks() - start, numChannels, numSamples);
+        return;
+    }
+
+    // type erased without allocating, the lambda lives on this stack frame until Run returns
+    using Callable = std::remove_reference_t<Fn>;
+    Run(numChannels, numSamples,
+        [](void* context, size_t channel) { (*static_cast<Callable*>(context))(channel); },
+        const_cast<void*>(static_cast<const void*>(std::addressof(perChannel))));
+}
@@ -0,0 +1,17 @@
+#include "EventDispatcher.h"
+
+//==============================================================================
+
+void EventDispatcher::Prepare(int newMinRunLength) {
+    minRunLength = std::max(newMinRunLength, 1);
+}
+
+void EventDispatcher::DrainIncoming() {
+    ParameterChange change;
+    while (numPending < pending.size() && incoming.TryPop(change)) {
+        size_t index = numPending++;
+        for (; index > 0 && pending[index - 1].sampleOffset > change.sampleOffset; --index)
+            pending[index] = pending[index - 1];
+        pending[index] = change;
+    }
+}
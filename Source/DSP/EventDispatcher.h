@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    Splits a block into runs at the MIDI events and parameter changes in it,
+    so they land on (close to) the right sample instead of the block start.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_audio_basics/juce_audio_basics.h>
+#include "Commons/PluginValueTree.h"
+#include "subnite_extras/common/spsc_queue.hpp"
+#include <array>
+
+//==============================================================================
+
+struct ParameterChange {
+    myplugin::vt::Property parameter = myplugin::vt::Property::P_POWER;
+    float value = 0.f;
+    int sampleOffset = 0; // into the next block, later offsets carry over to the blocks after it
+};
+
+// Events are merged by sample offset and every run starts at one. Runs are never shorter than the minimum run length
+// (except at the end of the block): events within that distance of a run's start are applied together at its start,
+// so they can be up to minRunLength - 1 samples early, but splitting never turns into per sample processing.
+class EventDispatcher {
+public:
+    static constexpr size_t maxPendingChanges = 256;
+
+    void Prepare(int newMinRunLength = 32);
+
+    // lock free, from one thread other than the audio thread. @return false when the queue is full
+    bool PushParameterChange(const ParameterChange& change) { return incoming.TryPush(change); }
+
+    // Audio thread. For every run: calls onParameter(change) and onMidi(metadata) for the events at its start, then processRun(start, length).
+    template <typename OnParameter, typename OnMidi, typename ProcessRun>
+    void Dispatch(const juce::MidiBuffer& midi, int numSamples, OnParameter&& onParameter, OnMidi&& onMidi, ProcessRun&& processRun);
+
+private:
+    // moves the queue into pending, sorted by offset. Same offsets keep their push order.
+    void DrainIncoming();
+
+    int minRunLength = 32;
+    subnite::SpscQueue<ParameterChange, maxPendingChanges> incoming{};
+    std::array<ParameterChange, maxPendingChanges> pending{};
+    size_t numPending = 0;
+};
+
+//==============================================================================
+
+template <typename OnParameter, typename OnMidi, typename ProcessRun>
+void EventDispatcher::Dispatch(const juce::MidiBuffer& midi, int numSamples, OnParameter&& onParameter, OnMidi&& onMidi, ProcessRun&& processRun) {
+    DrainIncoming();
+
+    size_t consumed = 0;
+    auto midiIterator = midi.cbegin();
+    const auto midiEnd = midi.cend();
+
+    int position = 0;
+    while (position < numSamples) {
+        // everything within the minimum run length belongs to this run
+        int end = std::min(numSamples, position + minRunLength);
+        for (; consumed < numPending && pending[consumed].sampleOffset < end; ++consumed)
+            onParameter(pending[consumed]);
+        for (; midiIterator != midiEnd && (*midiIterator).samplePosition < end; ++midiIterator)
+            onMidi(*midiIterator);
+
+        // and it goes on until the next event
+        end = numSamples;
+        if (consumed < numPending) end = std::min(end, pending[consumed].sampleOffset);
+        if (midiIterator != midiEnd) end = std::min(end, (*midiIterator).samplePosition);
+
+        processRun(position, end - position);
+        position = end;
+    }
+
+    // whatever is left belongs to the next blocks
+    for (size_t index = consumed; index < numPending; ++index) {
+        pending[index - consumed] = pending[index];
+        pending[index - consumed].sampleOffset -= numSamples;
+    }
+    numPending -= consumed;
+}
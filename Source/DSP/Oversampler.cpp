@@ -0,0 +1,47 @@
+#include "Oversampler.h"
+
+//==============================================================================
+
+namespace {
+
+template <typename FloatType>
+std::unique_ptr<juce::dsp::Oversampling<FloatType>> MakeOversampling(OversamplingSettings settings, size_t numChannels, size_t maxBlockSize) {
+    using Oversampling = juce::dsp::Oversampling<FloatType>;
+    const auto filter = settings.phase == OversamplingSettings::Phase::Linear
+        ? Oversampling::filterHalfBandFIREquiripple
+        : Oversampling::filterHalfBandPolyphaseIIR;
+
+    // max quality, integer latency so the reported latency is exact
+    auto oversampling = std::make_unique<Oversampling>(numChannels, static_cast<size_t>(settings.factor), filter, true, true);
+    oversampling->initProcessing(maxBlockSize);
+    return oversampling;
+}
+
+} // namespace
+
+void Oversampler::Prepare(OversamplingSettings newSettings, size_t newNumChannels, size_t newMaxBlockSize) {
+    newNumChannels = std::min(newNumChannels, myplugin::layouts::maxChannels);
+    const bool needsRebuild = !floatOversampling || newSettings != settings || newNumChannels != numChannels || newMaxBlockSize > maxBlockSize;
+
+    if (!needsRebuild) {
+        Reset();
+        return;
+    }
+
+    settings = newSettings;
+    numChannels = newNumChannels;
+    maxBlockSize = newMaxBlockSize;
+    floatOversampling = MakeOversampling<float>(settings, numChannels, maxBlockSize);
+    doubleOversampling = MakeOversampling<double>(settings, numChannels, maxBlockSize);
+}
+
+void Oversampler::Reset() {
+    if (!floatOversampling) return;
+    floatOversampling->reset();
+    doubleOversampling->reset();
+}
+
+int Oversampler::GetLatencySamples() const {
+    if (!IsEnabled() || !floatOversampling) return 0;
+    return juce::roundToInt(floatOversampling->getLatencyInSamples());
+}
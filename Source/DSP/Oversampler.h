@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+    Optional 2x/4x/8x oversampling around the processing, for both precisions.
+    All memory is allocated in Prepare (from prepareToPlay).
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+#include "ChannelLayouts.h"
+#include <array>
+#include <memory>
+
+//==============================================================================
+
+struct OversamplingSettings {
+    // the value is the number of 2x stages
+    enum class Factor { x1 = 0, x2 = 1, x4 = 2, x8 = 3 };
+    // minimum phase is the polyphase IIR half-band (less latency), linear phase the equiripple FIR half-band
+    enum class Phase { Minimum, Linear };
+
+    Factor factor = Factor::x1;
+    Phase phase = Phase::Minimum;
+
+    bool operator==(const OversamplingSettings&) const = default;
+};
+
+class Oversampler {
+public:
+    Oversampler() = default;
+
+    // allocates, call it from prepareToPlay. Only rebuilds the filters when something changed, resets them otherwise.
+    void Prepare(OversamplingSettings newSettings, size_t numChannels, size_t maxBlockSize);
+
+    // audio thread safe, clears the filters so nothing from before comes out again
+    void Reset();
+
+    // Upsamples the first GetNumChannels() channels of buffer. The returned buffer refers to the oversampler's memory
+    // and is GetFactor() times longer. buffer can't be longer than GetMaxBlockSize().
+    template <typename FloatType>
+    juce::AudioBuffer<FloatType> ProcessUp(const juce::AudioBuffer<FloatType>& buffer);
+
+    // filters the upsampled signal back down into buffer, the same buffer as ProcessUp got
+    template <typename FloatType>
+    void ProcessDown(juce::AudioBuffer<FloatType>& buffer);
+
+    bool IsEnabled() const { return settings.factor != OversamplingSettings::Factor::x1; }
+    size_t GetFactor() const { return size_t{1} << static_cast<size_t>(settings.factor); }
+    size_t GetNumChannels() const { return numChannels; }
+    size_t GetMaxBlockSize() const { return maxBlockSize; }
+    // at the host rate. Integer latency is used, so this is exact.
+    int GetLatencySamples() const;
+
+private:
+    template <typename FloatType>
+    juce::dsp::Oversampling<FloatType>& Get() {
+        if constexpr (std::is_same_v<FloatType, float>) return *floatOversampling;
+        else return *doubleOversampling;
+    }
+    template <typename FloatType>
+    std::array<FloatType*, myplugin::layouts::maxChannels>& GetPointers() {
+        if constexpr (std::is_same_v<FloatType, float>) return floatPointers;
+        else return doublePointers;
+    }
+
+    OversamplingSettings settings{};
+    size_t numChannels = 0;
+    size_t maxBlockSize = 0;
+
+    std::unique_ptr<juce::dsp::Oversampling<float>> floatOversampling;
+    std::unique_ptr<juce::dsp::Oversampling<double>> doubleOversampling;
+    // the channels of the upsampled buffer ProcessUp returns
+    std::array<float*, myplugin::layouts::maxChannels> floatPointers{};
+    std::array<double*, myplugin::layouts::maxChannels> doublePointers{};
+};
+
+//==============================================================================
+
+template <typename FloatType>
+juce::AudioBuffer<FloatType> Oversampler::ProcessUp(const juce::AudioBuffer<FloatType>& buffer) {
+    jassert(IsEnabled() && static_cast<size_t>(buffer.getNumSamples()) <= maxBlockSize);
+
+    const size_t channels = std::min(static_cast<size_t>(buffer.getNumChannels()), numChannels);
+    juce::dsp::AudioBlock<const FloatType> block{buffer.getArrayOfReadPointers(), channels, static_cast<size_t>(buffer.getNumSamples())};
+    auto upsampled = Get<FloatType>().processSamplesUp(block);
+
+    auto& pointers = GetPointers<FloatType>();
+    for (size_t channel = 0; channel < channels; ++channel)
+        pointers[channel] = upsampled.getChannelPointer(channel);
+
+    // refers to the pointers, doesn't allocate
+    return {pointers.data(), static_cast<int>(channels), static_cast<int>(upsampled.getNumSamples())};
+}
+
+template <typename FloatType>
+void Oversampler::ProcessDown(juce::AudioBuffer<FloatType>& buffer) {
+    const size_t channels = std::min(static_cast<size_t>(buffer.getNumChannels()), numChannels);
+    juce::dsp::AudioBlock<FloatType> block{buffer.getArrayOfWritePointers(), channels, static_cast<size_t>(buffer.getNumSamples())};
+    Get<FloatType>().processSamplesDown(block);
+}
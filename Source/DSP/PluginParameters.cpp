@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    Host automatable parameters for the properties of the value tree.
+
+  ==============================================================================
+*/
+
+#include "PluginParameters.h"
+
+//==============================================================================
+
+PluginParameters::PluginParameters(juce::AudioProcessor& processor, myplugin::vt::ValueTree& valueTree)
+    : tree(valueTree)
+{
+    for (const auto& spec : parameterSpecs) {
+        const auto index = static_cast<size_t>(spec.property);
+        jassert(entries[index].parameter == nullptr); // listed twice
+
+        auto parameter = std::make_unique<juce::AudioParameterFloat>(
+            juce::ParameterID{tree.GetID(spec.property).toString(), 1}, spec.name,
+            juce::NormalisableRange<float>{spec.minValue, spec.maxValue}, spec.defaultValue);
+
+        entries[index].owner = this;
+        entries[index].parameter = parameter.get();
+        entries[index].index = index;
+        parameter->addListener(this);
+        processor.addParameter(parameter.release());
+    }
+
+    tree.AddListener(this);
+
+    // headless (render cli, benchmarks) there's nothing to run a timer, the state readers call FlushPending instead
+    if (juce::MessageManager::getInstanceWithoutCreating() != nullptr) startTimerHz(flushRateHz);
+}
+
+PluginParameters::~PluginParameters()
+{
+    stopTimer();
+    tree.RemoveListener(this);
+    for (auto& entry : entries)
+        if (entry.parameter != nullptr) entry.parameter->removeListener(this);
+}
+
+void PluginParameters::UpdateSnapshot(subnite::vt::ParameterCache<Property>& cache) const
+{
+    // like the cache's seqlock: the parameters only count when no state load started or ended while reading them
+    const uint64_t sequence = loadSequence.load(std::memory_order_acquire);
+    cache.Update();
+    if ((sequence & 1) != 0) return;
+
+    std::array<float, numIDs> values{};
+    for (size_t index = 0; index < numIDs; ++index)
+        if (auto* parameter = entries[index].parameter) values[index] = parameter->get();
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (loadSequence.load(std::memory_order_relaxed) != sequence) return;
+
+    for (size_t index = 0; index < numIDs; ++index)
+        if (entries[index].parameter != nullptr) cache.Override(static_cast<Property>(index), values[index]);
+}
+
+void PluginParameters::BeginStateLoad()
+{
+    loadSequence.store(loadSequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void PluginParameters::EndStateLoad()
+{
+    loadSequence.store(loadSequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool PluginParameters::SetFromAudioThread(Property property, float value)
+{
+    const auto index = static_cast<size_t>(property);
+    auto* parameter = entries[index].parameter;
+    if (parameter == nullptr) return false;
+
+    // only stores the atomic, the listeners are called when the host is told
+    static_cast<juce::AudioProcessorParameter*>(parameter)->setValue(parameter->convertTo0to1(value));
+    MarkDirty(index, true);
+    return true;
+}
+
+subnite::SliderParameter* PluginParameters::GetSliderParameter(Property property)
+{
+    auto& entry = entries[static_cast<size_t>(property)];
+    return entry.parameter != nullptr ? &entry : nullptr;
+}
+
+void PluginParameters::FlushPending()
+{
+    const uint64_t hostMask = hostDirty.exchange(0, std::memory_order_relaxed);
+    const uint64_t treeMask = treeDirty.exchange(0, std::memory_order_relaxed);
+    if ((hostMask | treeMask) != 0) Flush(hostMask, treeMask);
+}
+
+void PluginParameters::WriteValuesTo(juce::ValueTree& state) const
+{
+    for (size_t index = 0; index < numIDs; ++index)
+        if (auto* parameter = entries[index].parameter)
+            state.setProperty(tree.GetID(static_cast<Property>(index)), static_cast<double>(parameter->get()), nullptr);
+}
+
+//==============================================================================
+
+void PluginParameters::Entry::BeginGesture()
+{
+    owner->FlushEntry(index); // whatever came before belongs outside the gesture
+    parameter->beginChangeGesture();
+}
+
+void PluginParameters::Entry::SetNormalized(double normalizedValue)
+{
+    static_cast<juce::AudioProcessorParameter*>(parameter)->setValue(static_cast<float>(normalizedValue));
+    owner->MarkDirty(index, true);
+}
+
+void PluginParameters::Entry::EndGesture()
+{
+    owner->FlushEntry(index); // the last value of the drag lands inside the gesture
+    parameter->endChangeGesture();
+}
+
+//==============================================================================
+
+void PluginParameters::MarkDirty(size_t index, bool tellHost)
+{
+    const uint64_t bit = uint64_t{1} << index;
+    if (tellHost) hostDirty.fetch_or(bit, std::memory_order_relaxed);
+    treeDirty.fetch_or(bit, std::memory_order_relaxed);
+}
+
+void PluginParameters::Flush(uint64_t hostMask, uint64_t treeMask)
+{
+    // the host first, telling it calls parameterValueChanged which flags the tree again
+    for (size_t index = 0; index < numIDs; ++index) {
+        if (((hostMask >> index) & 1) == 0) continue;
+        auto* parameter = entries[index].parameter;
+        parameter->sendValueChangedMessageToListeners(parameter->convertTo0to1(parameter->get()));
+    }
+    treeMask |= treeDirty.fetch_and(~hostMask, std::memory_order_relaxed) & hostMask;
+
+    isWritingTree = true;
+    for (size_t index = 0; index < numIDs; ++index) {
+        if (((treeMask >> index) & 1) == 0) continue;
+        tree.SetProperty(tree.GetID(static_cast<Property>(index)), static_cast<double>(entries[index].parameter->get()));
+    }
+    isWritingTree = false;
+}
+
+void PluginParameters::FlushEntry(size_t index)
+{
+    const uint64_t bit = uint64_t{1} << index;
+    const uint64_t hostMask = hostDirty.fetch_and(~bit, std::memory_order_relaxed) & bit;
+    const uint64_t treeMask = treeDirty.fetch_and(~bit, std::memory_order_relaxed) & bit;
+    Flush(hostMask, treeMask);
+}
+
+void PluginParameters::PullFromTree(size_t index)
+{
+    auto* parameter = entries[index].parameter;
+    if (parameter == nullptr) return;
+
+    const auto& value = tree.GetRoot().getProperty(tree.GetID(static_cast<Property>(index)));
+    if (!(value.isDouble() || value.isInt() || value.isInt64() || value.isBool())) return; // missing from the tree, keep the current value
+
+    const auto newValue = static_cast<float>(static_cast<double>(value));
+    if (!juce::exactlyEqual(newValue, parameter->get()))
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(newValue));
+}
+
+//==============================================================================
+
+void PluginParameters::parameterValueChanged(int parameterIndex, float newValue)
+{
+    // any thread, hosts often automate from the audio thread
+    juce::ignoreUnused(newValue);
+    for (size_t index = 0; index < numIDs; ++index) {
+        auto* parameter = entries[index].parameter;
+        if (parameter != nullptr && parameter->getParameterIndex() == parameterIndex) MarkDirty(index, false);
+    }
+}
+
+void PluginParameters::parameterGestureChanged(int parameterIndex, bool gestureIsStarting)
+{
+    juce::ignoreUnused(parameterIndex, gestureIsStarting);
+}
+
+void PluginParameters::valueTreePropertyChanged(juce::ValueTree& changedTree, const juce::Identifier& property)
+{
+    if (isWritingTree || changedTree != tree.GetRoot()) return; // parameters are properties of the root
+
+    if (auto type = tree.GetTypeFromID(property)) PullFromTree(static_cast<size_t>(*type));
+}
+
+void PluginParameters::valueTreeRedirected(juce::ValueTree& redirectedTree)
+{
+    // a new root (Create, CopyFrom, ...), every parameter follows it
+    juce::ignoreUnused(redirectedTree);
+    for (size_t index = 0; index < numIDs; ++index) PullFromTree(index);
+}
+
+void PluginParameters::timerCallback()
+{
+    FlushPending();
+}
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    Host automatable parameters for the properties of the value tree.
+    The values live in the parameters' atomics, so automation reaches the
+    audio thread directly. The tree and the host are updated in batches.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_audio_processors/juce_audio_processors.h>
+#include "Commons/PluginValueTree.h"
+#include "subnite_extras/common/parameter_cache.hpp"
+#include "subnite_extras/gui/slider_parameter.h"
+#include <array>
+#include <atomic>
+
+//==============================================================================
+
+struct ParameterSpec {
+    myplugin::vt::Property property = myplugin::vt::Property::P_POWER;
+    const char* name = ""; // what the host shows
+    float minValue = 0.f;
+    float maxValue = 1.f;
+    float defaultValue = 0.f;
+};
+
+// every property the host can automate. The tree identifier doubles as the parameter id, so don't rename those.
+inline constexpr std::array parameterSpecs {
+    ParameterSpec{myplugin::vt::Property::P_POWER, "Power", 0.f, 1.f, 0.69f},
+};
+
+// Changes from the host or the audio thread are written to the tree on a timer, and gui changes are sent to the host on it,
+// so a drag or a dense automation lane costs at most one tree write and one host notification per parameter per tick.
+// Tree changes that didn't come from here (state loads, undo) are sent to the parameters right away.
+// Without a message manager there is no timer, and only FlushPending brings the tree up to date.
+class PluginParameters : private juce::AudioProcessorParameter::Listener,
+                         private juce::ValueTree::Listener,
+                         private juce::Timer {
+public:
+    using Property = myplugin::vt::Property;
+    static constexpr size_t numIDs = myplugin::vt::ValueTree::numIDs;
+    static constexpr int flushRateHz = 30;
+    static_assert(numIDs <= 64, "the dirty flags are one 64 bit mask");
+
+    // message thread. Adds a parameter for every spec to processor, which owns them.
+    PluginParameters(juce::AudioProcessor& processor, myplugin::vt::ValueTree& tree);
+    ~PluginParameters() override;
+
+    // any thread. nullptr for properties that aren't parameters.
+    juce::AudioParameterFloat* GetParameter(Property property) const { return entries[static_cast<size_t>(property)].parameter; }
+
+    // audio thread, at the start of every block instead of cache.Update(). Takes the cache's snapshot and puts the current value
+    // of every parameter in it, unless a state load overlapped: then the snapshot alone has all of one state.
+    void UpdateSnapshot(subnite::vt::ParameterCache<Property>& cache) const;
+
+    // message thread, around replacing the tree's root. The parameters follow it one by one, so UpdateSnapshot
+    // leaves them out of the blocks in between.
+    void BeginStateLoad();
+    void EndStateLoad();
+
+    // audio thread, for changes that don't come from the host. The host and tree hear about it on the next tick.
+    // @return false when property isn't a parameter
+    bool SetFromAudioThread(Property property, float value);
+
+    // message thread, for Slider::bindParameter. nullptr for properties that aren't parameters.
+    subnite::SliderParameter* GetSliderParameter(Property property);
+
+    // message thread, or whichever thread owns the processor when there's no message manager (headless, the timer never runs then).
+    // Sends every pending change to the host and the tree right away, call it before reading the tree for the state.
+    void FlushPending();
+    // any thread. @return true while FlushPending has something to do
+    bool HasPending() const { return (hostDirty.load(std::memory_order_relaxed) | treeDirty.load(std::memory_order_relaxed)) != 0; }
+
+    // any thread. Writes the current value of every parameter into state (a copy of the tree, nothing listens to it),
+    // for state readers that aren't allowed to FlushPending.
+    void WriteValuesTo(juce::ValueTree& state) const;
+
+private:
+    class Entry : public subnite::SliderParameter {
+    public:
+        PluginParameters* owner = nullptr;
+        juce::AudioParameterFloat* parameter = nullptr;
+        size_t index = 0;
+
+        double GetNormalized() const override { return parameter->convertTo0to1(parameter->get()); }
+        void BeginGesture() override;
+        void SetNormalized(double normalizedValue) override;
+        void EndGesture() override;
+    };
+
+    // flags a change that the tree, and with tellHost also the host, hasn't heard about yet. Lock free.
+    void MarkDirty(size_t index, bool tellHost);
+    // message thread
+    void Flush(uint64_t hostMask, uint64_t treeMask);
+    void FlushEntry(size_t index);
+    void PullFromTree(size_t index);
+
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override;
+    void valueTreePropertyChanged(juce::ValueTree& changedTree, const juce::Identifier& property) override;
+    void valueTreeRedirected(juce::ValueTree& redirectedTree) override;
+    void timerCallback() override;
+
+    myplugin::vt::ValueTree& tree;
+    std::array<Entry, numIDs> entries{};
+    std::atomic<uint64_t> hostDirty{0}; // set by the gui and the audio thread
+    std::atomic<uint64_t> treeDirty{0}; // set by every parameter change
+    std::atomic<uint64_t> loadSequence{0}; // odd while a state load is pulling the parameters
+    bool isWritingTree = false; // message thread, so Flush doesn't hear its own tree writes
+};
@@ -42,41 +42,111 @@ void MyPluginProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
 
-    // assuming stereo channels
-    int channels = getMainBusNumInputChannels();
-    busSettingsChanged({
+    int channels = std::max(getTotalNumInputChannels(), getTotalNumOutputChannels());
+    BusSettings settings {
         .sampleRate = static_cast<size_t>(sampleRate),
         .bufferSize = static_cast<size_t>(samplesPerBlock),
         .channels = static_cast<size_t>(channels),
-    }); // didn't actually check if they changed, so this can be used as initializer too.
+    };
+
+    // all scratch memory is allocated here, for the biggest block we were told about
+    BusSettings maximum = settings;
+    maximum.bufferSize = std::max(settings.bufferSize, declaredMaxBufferSize);
+
+    // the filters are sized for the same maximum, the processing sees getSampleRate() * oversampler.GetFactor()
+    oversampler.Prepare(oversamplingSettings, maximum.channels, maximum.bufferSize);
+    // so the scratch memory holds a block at that rate
+    reconfiguration.Prepare(settings, maximum, oversampler.GetFactor());
+    setLatencySamples(oversampler.GetLatencySamples());
+    bypass.Prepare(sampleRate, static_cast<int>(maximum.channels), static_cast<int>(maximum.bufferSize), getLatencySamples());
+    silence.Prepare(juce::roundToInt(getTailLengthSeconds() * sampleRate));
+    events.Prepare(minEventRunLength);
+    // ramps are read at the oversampled rate, and start out at the current values instead of gliding up from 0
+    smoothedParameters.Prepare(sampleRate * static_cast<double>(oversampler.GetFactor()), maximum.bufferSize * oversampler.GetFactor());
+    hostParameters.UpdateSnapshot(parameters);
+    smoothedParameters.SetTargets(parameters.GetValues());
+    smoothedParameters.Snap();
+    channelWorkers.Prepare(numChannelWorkers, sampleRate * static_cast<double>(oversampler.GetFactor()), static_cast<int>(maximum.bufferSize * oversampler.GetFactor()));
+
+    busSettingsChanged(settings); // didn't actually check if they changed, so this can be used as initializer too.
 }
 
-void MyPluginProcessor::prepareToPlayFull(double sampleRate, size_t samplesPerBlock, size_t inChannels, size_t outChannels) {
-    // First set processor's channel layout
-    juce::AudioProcessor::BusesLayout layout;
-    juce::Array<juce::AudioChannelSet> inputBuses;
-    if (inChannels > 0 && inChannels < 3)
-        inputBuses.add( inChannels == 1 ? juce::AudioChannelSet::mono() : juce::AudioChannelSet::stereo());
-    layout.inputBuses = inputBuses;
+void MyPluginProcessor::prepareToPlayFull(double sampleRate, size_t samplesPerBlock, size_t inChannels, size_t outChannels, size_t maxSamplesPerBlock) {
+    prepareToPlayFull(sampleRate, samplesPerBlock,
+        myplugin::layouts::ForChannelCount(inChannels), myplugin::layouts::ForChannelCount(outChannels), maxSamplesPerBlock);
+}
 
-    juce::Array<juce::AudioChannelSet> outputBuses;
-    if (outChannels > 0 && outChannels < 3)
-        outputBuses.add( outChannels == 1 ? juce::AudioChannelSet::mono() : juce::AudioChannelSet::stereo());
+void MyPluginProcessor::prepareToPlayFull(double sampleRate, size_t samplesPerBlock, const juce::AudioChannelSet& inLayout, const juce::AudioChannelSet& outLayout, size_t maxSamplesPerBlock) {
+    declaredMaxBufferSize = maxSamplesPerBlock;
 
-    layout.outputBuses= outputBuses;
-    setBusesLayout(layout);
+    // First set processor's channel layout, a disabled set means no bus at all
+    juce::AudioProcessor::BusesLayout layout;
+    if (!inLayout.isDisabled()) layout.inputBuses.add(inLayout);
+    if (!outLayout.isDisabled()) layout.outputBuses.add(outLayout);
+
+    jassert(isBusesLayoutSupported(layout));
+    if (layout != getBusesLayout()) setBusesLayout(layout); // skipped when re-preparing with the same channels
 
     // then set sample rate and buffer size details
     setRateAndBufferSizeDetails(sampleRate, static_cast<int>(samplesPerBlock));
 
-    prepareToPlay(sampleRate, samplesPerBlock);
+    prepareToPlay(sampleRate, static_cast<int>(samplesPerBlock));
 }
 
 
+void MyPluginProcessor::setOversampling(OversamplingSettings newSettings)
+{
+    if (newSettings == oversamplingSettings) return;
+    oversamplingSettings = newSettings;
+    if (getSampleRate() <= 0.0) return; // picked up by the first prepareToPlay
+
+    // the filters are reallocated, so keep the audio callback out while that happens
+    suspendProcessing(true);
+    prepareToPlay(getSampleRate(), getBlockSize());
+    suspendProcessing(false);
+}
+
+void MyPluginProcessor::setChannelWorkers(size_t numWorkers)
+{
+    if (numWorkers == numChannelWorkers) return;
+    numChannelWorkers = numWorkers;
+    if (getSampleRate() <= 0.0) return; // picked up by the first prepareToPlay
+
+    suspendProcessing(true);
+    channelWorkers.Prepare(numChannelWorkers, getSampleRate() * static_cast<double>(oversampler.GetFactor()), getBlockSize() * static_cast<int>(oversampler.GetFactor()));
+    suspendProcessing(false);
+}
+
 void MyPluginProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
 {
-    juce::ignoreUnused(midiMessages);
+    processBlockInternal(buffer, midiMessages, false);
+}
+
+void MyPluginProcessor::processBlock(juce::AudioBuffer<double> &buffer, juce::MidiBuffer &midiMessages)
+{
+    processBlockInternal(buffer, midiMessages, false);
+}
+
+void MyPluginProcessor::processBlockBypassed(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
+{
+    processBlockInternal(buffer, midiMessages, true);
+}
+
+void MyPluginProcessor::processBlockBypassed(juce::AudioBuffer<double> &buffer, juce::MidiBuffer &midiMessages)
+{
+    processBlockInternal(buffer, midiMessages, true);
+}
+
+bool MyPluginProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+template <typename FloatType>
+void MyPluginProcessor::processBlockInternal(juce::AudioBuffer<FloatType> &buffer, juce::MidiBuffer &midiMessages, bool isBypassed)
+{
     juce::ScopedNoDenormals noDenormals;
+    subnite::LoadMeter::ScopedMeasurement measurement{loadMeter, buffer.getNumSamples(), getSampleRate()};
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -85,20 +155,130 @@ void MyPluginProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::Mid
         buffer.clear(i, 0, buffer.getNumSamples());
     }
 
-    // checking for differing settings
-    auto tInChannels = static_cast<size_t>(totalNumInputChannels);
-    auto tNumSamples = static_cast<size_t>(buffer.getNumSamples());
-    auto tSampleRate = static_cast<size_t>(getSampleRate());
-    if (tInChannels != busSettings.channels || tNumSamples != busSettings.bufferSize || tSampleRate != busSettings.sampleRate){
-        busSettings = {
-            .sampleRate = tSampleRate,
-            .bufferSize = tNumSamples,
-            .channels = tInChannels,
-        };
-        busSettingsChanged(busSettings);
+    // checking for differing settings. Blocks shorter than the prepared size are normal (hosts and the dyn_lib split blocks), only longer ones need reconfiguring.
+    // Changes that fit the memory from prepareToPlay are absorbed without allocating, bigger ones are allocated on the message thread.
+    BusSettings settings {
+        .sampleRate = static_cast<size_t>(getSampleRate()),
+        .bufferSize = static_cast<size_t>(buffer.getNumSamples()),
+        .channels = static_cast<size_t>(totalNumInputChannels),
+    };
+    if (reconfiguration.Update(settings))
+        busSettingsChanged(reconfiguration.GetSettings());
+
+    // silent input past the tail can't make any sound, so the DSP sleeps and the block is just cleared
+    // bypassed or MIDI blocks skip the scan, and restart the count so the DSP doesn't fall asleep right after them
+    const bool mayBeSilent = !isBypassed && midiMessages.isEmpty();
+    if (!mayBeSilent) silence.Reset();
+    const bool isSleeping = mayBeSilent && silence.CanSleep(buffer, totalNumInputChannels);
+    if (bypass.BeginBlock(isBypassed))
+        resetProcessingState(); // otherwise the fade in starts with whatever was in the filters when the bypass started
+
+    // whatever the GUI changed in the tree since the last block, read with parameters.Get() from here on.
+    // Host parameters go straight in, their tree values lag behind by a timer tick.
+    hostParameters.UpdateSnapshot(parameters);
+
+    auto& scratch = reconfiguration.GetScratch();
+    size_t maxChunkSize = std::min(scratch.capacity.bufferSize, static_cast<size_t>(bypass.GetMaxBlockSize()));
+    if (oversampler.IsEnabled()) maxChunkSize = std::min(maxChunkSize, oversampler.GetMaxBlockSize());
+    const int chunkSize = static_cast<int>(maxChunkSize);
+    if (chunkSize == 0) return; // never prepared
+
+    // runs from one MIDI event or parameter change to the next, so they land on the right sample
+    events.Dispatch(midiMessages, buffer.getNumSamples(),
+        [this](const ParameterChange& change) { applyParameterChange(change); },
+        [this](const juce::MidiMessageMetadata& metadata) { handleMidiEvent(metadata.getMessage()); },
+        [&](int start, int length) {
+            smoothedParameters.SetTargets(parameters.GetValues()); // with the changes at the start of this run
+            // until bigger memory is swapped in, process in pieces that fit the scratch memory
+            for (int chunkStart = start; chunkStart < start + length; chunkStart += chunkSize) {
+                juce::AudioBuffer<FloatType> chunk{buffer.getArrayOfWritePointers(), buffer.getNumChannels(), chunkStart, std::min(chunkSize, start + length - chunkStart)};
+                processChunk(chunk, scratch, isSleeping);
+            }
+        });
+
+    // below the threshold isn't necessarily zero, make it real digital silence
+    if (isSleeping) buffer.clear();
+}
+
+void MyPluginProcessor::resetProcessingState()
+{
+    oversampler.Reset();
+    smoothedParameters.Snap();
+    // clear your DSP's state here (filters, delay lines, envelopes, ...)
+}
+
+void MyPluginProcessor::applyParameterChange(const ParameterChange &change)
+{
+    // called at the start of the run the change lands in, update the DSP from here
+    parameters.Override(change.parameter, change.value);
+    hostParameters.SetFromAudioThread(change.parameter, change.value); // so the next blocks, the host and the tree keep it
+}
+
+void MyPluginProcessor::handleMidiEvent(const juce::MidiMessage &message)
+{
+    // called at the start of the run the message lands in
+    juce::ignoreUnused(message);
+}
+
+template <typename FloatType>
+void MyPluginProcessor::processChunk(juce::AudioBuffer<FloatType> &buffer, ScratchMemory &scratch, bool isSleeping)
+{
+    // false once fully bypassed, then the chunk only goes through the latency delay
+    const bool shouldProcess = bypass.PushDry(buffer) && !isSleeping;
+    if (!shouldProcess) smoothedParameters.Snap(); // nothing to glide from once processing picks up again
+
+    if (shouldProcess && !oversampler.IsEnabled())
+    {
+        dispatchChannels(buffer, scratch);
+    }
+    else if (shouldProcess)
+    {
+        // channels beyond oversampler.GetNumChannels() (only while bigger memory is on its way) aren't processed
+        auto upsampled = oversampler.ProcessUp(buffer);
+        dispatchChannels(upsampled, scratch);
+        oversampler.ProcessDown(buffer);
+    }
+
+    bypass.EndChunk(buffer);
+}
+
+template <typename FloatType>
+void MyPluginProcessor::dispatchChannels(juce::AudioBuffer<FloatType> &buffer, ScratchMemory &scratch)
+{
+    smoothedParameters.Advance(static_cast<size_t>(buffer.getNumSamples()));
+
+    // the common layouts get a kernel with a fixed channel count, so the channel loops unroll and stereo doesn't pay for 64 channel support
+    switch (buffer.getNumChannels())
+    {
+    case 1:  processChannels<1>(buffer, scratch); break;
+    case 2:  processChannels<2>(buffer, scratch); break;
+    case 4:  processChannels<4>(buffer, scratch); break;  // quad, 1st order ambisonics
+    case 6:  processChannels<6>(buffer, scratch); break;  // 5.1
+    case 8:  processChannels<8>(buffer, scratch); break;  // 7.1
+    case 12: processChannels<12>(buffer, scratch); break; // 7.1.4
+    case 16: processChannels<16>(buffer, scratch); break; // 3rd order ambisonics
+    default: processChannels<myplugin::layouts::dynamicChannelCount>(buffer, scratch); break;
     }
+}
 
-    // do processing from here
+template <size_t NumChannels, typename FloatType>
+void MyPluginProcessor::processChannels(juce::AudioBuffer<FloatType> &buffer, ScratchMemory &scratch)
+{
+    // a compile time constant for the specialized kernels
+    const size_t numChannels = NumChannels == myplugin::layouts::dynamicChannelCount ? static_cast<size_t>(buffer.getNumChannels()) : NumChannels;
+    FloatType* const* channels = buffer.getArrayOfWritePointers();
+    const int numSamples = buffer.getNumSamples();
+
+    // scratch.Get<FloatType>() holds numSamples, also when oversampling. It has scratch.capacity.channels channels,
+    // which can be less than numChannels while bigger memory is on its way.
+    const float* power = smoothedParameters.GetRamp(myplugin::vt::Property::P_POWER); // numSamples values, one per sample
+    juce::ignoreUnused(numChannels, channels, numSamples, scratch, power);
+
+    // do processing from here, loop over numChannels.
+    // Independent per channel work can go through the worker pool, which runs it serially when it measures that waking the workers wouldn't pay off.
+    channelWorkers.ForEachChannel(numChannels, static_cast<size_t>(numSamples), [&](size_t channel) {
+        juce::ignoreUnused(channels[channel]);
+    });
 }
 
 const juce::String MyPluginProcessor::getName() const
@@ -135,7 +315,10 @@ bool MyPluginProcessor::isMidiEffect() const
 
 double MyPluginProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // the output keeps going for the latency after the input stops, on top of what the DSP itself rings for
+    const double sampleRate = getSampleRate();
+    const double latencySeconds = sampleRate > 0.0 ? getLatencySamples() / sampleRate : 0.0;
+    return dspTailSeconds + latencySeconds;
 }
 
 int MyPluginProcessor::getNumPrograms()
@@ -181,10 +364,10 @@ bool MyPluginProcessor::isBusesLayoutSupported(const BusesLayout &layouts) const
     return true;
 #else
     // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
+    // Any discrete, surround or ambisonic layout works, up to layouts::maxChannels.
     // Some plugin hosts, such as certain GarageBand versions, will only
     // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono() && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    if (!myplugin::layouts::IsSupported(layouts.getMainOutputChannelSet()))
         return false;
 
         // This checks if the input layout matches the output layout
@@ -216,15 +399,35 @@ void MyPluginProcessor::getStateInformation(juce::MemoryBlock &destData)
     juce::ignoreUnused(destData);
     // You should use this method to store your parameters in the memory block.
 
-    juce::MemoryOutputStream stream(destData, true);
-    if (vTree.IsValid())
+    // a state the host just set but that isn't swapped in yet is still the current state as far as the host knows
+    if (stateLoader.GetPendingData(destData)) return;
+
+    if (!vTree.IsValid()) return;
+
+    // the timer may not have run since the last automation, or at all when headless. Flushing writes the tree, and through it the
+    // parameter cache, which has a single writer: the message thread. Hosts that ask from another thread get a copy with the current values.
+    auto* messageManager = juce::MessageManager::getInstanceWithoutCreating();
+    juce::ValueTree state = vTree.GetRoot();
+    if (messageManager == nullptr || messageManager->isThisTheMessageThread())
+    {
+        flushParameterChanges();
+    }
+    else
     {
-        vTree.WriteToStream(stream);
+        state = state.createCopy();
+        hostParameters.WriteValuesTo(state);
+    }
+
+    juce::MemoryOutputStream stream(destData, true);
+    // setStateInformation reads both formats, so turning useCompactState off only matters for older builds reading newer sessions
+    if constexpr (useCompactState)
+        subnite::vt::ValueTreeBase::WriteCompactToStream(state, stream, compressState);
+    else
+        state.writeToStream(stream);
 
 #ifdef CMAKE_DEBUG
-        // vTree.CreateXML("C:/Path/To/MyPlugin/getStateOutputTree.xml");
+    // vTree.CreateXML("C:/Path/To/MyPlugin/getStateOutputTree.xml");
 #endif
-    }
 }
 
 void MyPluginProcessor::setStateInformation(const void *data, int sizeInBytes)
@@ -232,15 +435,37 @@ void MyPluginProcessor::setStateInformation(const void *data, int sizeInBytes)
     juce::ignoreUnused(data, sizeInBytes);
     // You should use this method to restore your parameters from this memory block, whose contents will have been created by the getStateInformation() call.
 
-    vTree.CopyFrom(data, sizeInBytes);
-    if (!vTree.IsValid())
-        vTree.Create(); // this shouldn't happen, unless there were breaking changes in an update
+    const auto size = static_cast<size_t>(std::max(0, sizeInBytes));
+
+    // offline renders need the state before the next block, and without a message manager nothing would pick it up
+    if constexpr (restoreStateAsync)
+    {
+        if (!isNonRealtime() && juce::MessageManager::getInstanceWithoutCreating() != nullptr)
+        {
+            stateLoader.Load(data, size);
+            return;
+        }
+    }
+
+    stateLoader.Cancel(); // an older async load mustn't overwrite this one
+    applyLoadedState(myplugin::vt::ValueTree::ReadTree(data, size));
 
 #ifdef CMAKE_DEBUG
     // vTree.CreateXML("C:/Path/To/MyPlugin/setStateOutputTree.xml");
 #endif
 }
 
+void MyPluginProcessor::applyLoadedState(const juce::ValueTree &tree)
+{
+    // the cache publishes the new root's values in one go, but the parameters follow one at a time. Until the last one did,
+    // the audio thread leaves them out, so every block sees all of the old state or all of the new one.
+    hostParameters.BeginStateLoad();
+    vTree.ReplaceRoot(tree);
+    if (!vTree.IsValid())
+        vTree.Create(); // this shouldn't happen, unless there were breaking changes in an update
+    hostParameters.EndStateLoad();
+}
+
 //==============================================================================
 // This creates new instances of the plugin..
 juce::AudioProcessor *JUCE_CALLTYPE createPluginFilter()
@@ -9,15 +9,21 @@
 #pragma once
 #include <juce_audio_processors/juce_audio_processors.h>
 #include "Commons/PluginValueTree.h"
+#include "Reconfiguration.h"
+#include "ChannelLayouts.h"
+#include "Oversampler.h"
+#include "ChannelWorkers.h"
+#include "Bypass.h"
+#include "SilenceDetector.h"
+#include "EventDispatcher.h"
+#include "PluginParameters.h"
+#include "subnite_extras/common/load_meter.hpp"
+#include "subnite_extras/common/parameter_cache.hpp"
+#include "subnite_extras/common/parameter_smoother.hpp"
+#include "subnite_extras/common/async_tree_loader.hpp"
 
 //==============================================================================
 
-struct BusSettings {
-    size_t sampleRate = 48000;
-    size_t bufferSize = 512;
-    size_t channels = 2;
-};
-
 class MyPluginProcessor  : public juce::AudioProcessor
 #if JucePlugin_Enable_ARA
 , public juce::AudioProcessorARAExtension
@@ -30,7 +36,10 @@ public:
 
     //==============================================================================
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
-    void prepareToPlayFull(double sampleRate, size_t samplesPerBlock, size_t inChannels, size_t outChannels);
+    // maxSamplesPerBlock preallocates for bigger blocks than samplesPerBlock, so they won't need reconfiguring later
+    void prepareToPlayFull(double sampleRate, size_t samplesPerBlock, size_t inChannels, size_t outChannels, size_t maxSamplesPerBlock = 0);
+    // same, for when the layout matters and not just the channel count (7.1.4 vs. 12 discrete channels)
+    void prepareToPlayFull(double sampleRate, size_t samplesPerBlock, const juce::AudioChannelSet& inLayout, const juce::AudioChannelSet& outLayout, size_t maxSamplesPerBlock = 0);
 
     void releaseResources() override;
 
@@ -38,9 +47,33 @@ public:
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
 #endif
 
-    using juce::AudioProcessor::processBlock; // there is a "double" version of processblock. This let's the bass class handle it.
+    // both precisions run the same templated core, so 64 bit hosts don't have to convert down to float and back
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-    // void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) = delete;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
+    // the dry signal delayed by the reported latency, crossfaded when switching so it doesn't click
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    // message thread. Re-prepares right away when already prepared, which changes the reported latency.
+    void setOversampling(OversamplingSettings newSettings);
+    OversamplingSettings getOversampling() const { return oversamplingSettings; }
+
+    // message thread. Spreads per channel work of wide layouts over numWorkers realtime threads (plus the audio thread), 0 turns it off.
+    void setChannelWorkers(size_t numWorkers);
+    size_t getChannelWorkers() const { return numChannelWorkers; }
+
+    // lock free, from one thread other than the audio thread. The change lands sampleOffset samples into the next block.
+    bool pushParameterChange(const ParameterChange& change) { return events.PushParameterChange(change); }
+
+    // message thread, for subnite::Slider::bindParameter. nullptr for properties the host can't automate.
+    subnite::SliderParameter* getSliderParameter(myplugin::vt::Property property) { return hostParameters.GetSliderParameter(property); }
+
+    // message thread (or with no message manager, the thread that owns the processor). Writes pending parameter changes to vTree,
+    // so it's up to date before it's read for the state. getStateInformation does this itself.
+    void flushParameterChanges() { hostParameters.FlushPending(); }
+    // any thread. @return true when flushParameterChanges has changes to write
+    bool hasPendingParameterChanges() const { return hostParameters.HasPending(); }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -69,10 +102,57 @@ public:
 
     // contains all info that is stored and restored from the plugin data block
     myplugin::vt::ValueTree vTree{};
+    // how long every processBlock took compared to its budget, lock free to read from any thread
+    subnite::LoadMeter loadMeter{};
 private:
 
-  BusSettings busSettings;
+  ReconfigurationEngine reconfiguration;
+  size_t declaredMaxBufferSize = 0;
+  OversamplingSettings oversamplingSettings{}; // off by default, applied in prepareToPlay
+  Oversampler oversampler;
+  size_t numChannelWorkers = 0; // off by default, applied in prepareToPlay
+  ChannelWorkerPool channelWorkers;
+  BypassEngine bypass;
+  SilenceDetector silence;
+  // how long the processing keeps ringing after the input goes silent (reverbs, delays, ...). Set this for your DSP,
+  // it's reported to the host and decides when the DSP can sleep. The latency is added on top.
+  static constexpr double dspTailSeconds = 0.0;
+  EventDispatcher events;
+  static constexpr int minEventRunLength = 32; // events closer together than this are applied together
+  // the numeric properties of vTree as plain floats for the audio thread, one consistent snapshot per block
+  subnite::vt::ParameterCache<myplugin::vt::Property> parameters{vTree, vTree};
+  // the same values ramped per sample, at the processing rate. Read these in the DSP, parameters.Get() for ones that shouldn't glide.
+  subnite::vt::ParameterSmoother<myplugin::vt::Property> smoothedParameters;
+  // the automatable properties, their values reach the audio thread without waiting for the tree
+  PluginParameters hostParameters{*this, vTree};
+  // getStateInformation writes a snapshot with an id table (subnite_extras/common/value_tree_snapshot.h), zlib compressed when that's smaller.
+  // It's the same format as the dyn_lib's snapshots, so either can be restored from the other.
+  static constexpr bool useCompactState = true;
+  static constexpr bool compressState = true;
+  // setStateInformation parses on a worker and swaps the tree in on the message thread, processing keeps the old state until then
+  static constexpr bool restoreStateAsync = true;
+  subnite::vt::AsyncTreeLoader stateLoader{[this](juce::ValueTree tree) { applyLoadedState(tree); }, &myplugin::vt::ValueTree::ReadTree};
+  // message thread, with the tree from stateLoader
+  void applyLoadedState(const juce::ValueTree& tree);
+  // called on the audio thread, so never allocate in here. Use the scratch memory instead.
   void busSettingsChanged(BusSettings newSettings);
+
+  template <typename FloatType>
+  void processBlockInternal(juce::AudioBuffer<FloatType>& buffer, juce::MidiBuffer& midiMessages, bool isBypassed);
+  // audio thread, so never allocate in here. Clears what the processing still holds, coming out of bypass.
+  void resetProcessingState();
+  // audio thread, at the start of the run the event lands in
+  void applyParameterChange(const ParameterChange& change);
+  void handleMidiEvent(const juce::MidiMessage& message);
+  // buffer is never longer than scratch.capacity.bufferSize, or the oversampler's max block size when it's on
+  template <typename FloatType>
+  void processChunk(juce::AudioBuffer<FloatType>& buffer, ScratchMemory& scratch, bool isSleeping);
+  // buffer is at the oversampled rate here
+  template <typename FloatType>
+  void dispatchChannels(juce::AudioBuffer<FloatType>& buffer, ScratchMemory& scratch);
+  // NumChannels is known at compile time for the common layouts, or layouts::dynamicChannelCount for the rest
+  template <size_t NumChannels, typename FloatType>
+  void processChannels(juce::AudioBuffer<FloatType>& buffer, ScratchMemory& scratch);
   //==============================================================================
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MyPluginProcessor)
 };
@@ -0,0 +1,101 @@
+#include "Reconfiguration.h"
+
+//==============================================================================
+
+void ScratchMemory::Allocate(BusSettings maximum, size_t newOversamplingFactor) {
+    capacity = maximum;
+    oversamplingFactor = newOversamplingFactor;
+    const auto numChannels = static_cast<int>(maximum.channels);
+    const auto numSamples = static_cast<int>(maximum.bufferSize * oversamplingFactor);
+
+    // keepExistingContent = false, clearExtraSpace = true, avoidReallocating = true
+    floatBuffer.setSize(numChannels, numSamples, false, true, true);
+    doubleBuffer.setSize(numChannels, numSamples, false, true, true);
+}
+
+bool ScratchMemory::Fits(const BusSettings& settings) const {
+    return settings.channels <= capacity.channels
+        && settings.bufferSize <= capacity.bufferSize;
+}
+
+//==============================================================================
+
+ReconfigurationEngine::ReconfigurationEngine() {
+    if (juce::MessageManager::getInstanceWithoutCreating() != nullptr) startTimerHz(pollRateHz);
+}
+
+ReconfigurationEngine::~ReconfigurationEngine() {
+    stopTimer();
+    delete incoming.exchange(nullptr);
+    delete retired.exchange(nullptr);
+}
+
+void ReconfigurationEngine::Prepare(BusSettings settings, BusSettings maximum, size_t newOversamplingFactor) {
+    maximum.channels = std::max(maximum.channels, settings.channels);
+    maximum.bufferSize = std::max(maximum.bufferSize, settings.bufferSize);
+    maximum.sampleRate = settings.sampleRate;
+
+    std::lock_guard<std::mutex> lock{allocationMutex};
+
+    // nothing is processing now, so anything in flight can go
+    delete incoming.exchange(nullptr);
+    delete retired.exchange(nullptr);
+
+    oversamplingFactor = std::max<size_t>(newOversamplingFactor, 1);
+    active->Allocate(maximum, oversamplingFactor);
+    allocated = maximum;
+    requestedBufferSize = maximum.bufferSize;
+    requestedChannels = maximum.channels;
+    workPending = false;
+    current = settings;
+}
+
+bool ReconfigurationEngine::Update(const BusSettings& settings) {
+    // swap in bigger memory once the message thread made it, and hand the old one back to be freed there
+    if (retired.load() == nullptr) {
+        if (auto* fresh = incoming.exchange(nullptr)) {
+            retired.store(active.release());
+            active.reset(fresh);
+            workPending.store(true, std::memory_order_release);
+        }
+    }
+
+    const bool changed = settings.channels != current.channels
+        || settings.sampleRate != current.sampleRate
+        || settings.bufferSize > current.bufferSize;
+    if (!changed) return false;
+
+    current.channels = settings.channels;
+    current.sampleRate = settings.sampleRate;
+    current.bufferSize = std::max(current.bufferSize, settings.bufferSize);
+
+    if (!active->Fits(current)) {
+        // doesn't fit, ask the message thread for more
+        requestedBufferSize = std::max(requestedBufferSize.load(), current.bufferSize);
+        requestedChannels = std::max(requestedChannels.load(), current.channels);
+        workPending.store(true, std::memory_order_release);
+    }
+    return true;
+}
+
+void ReconfigurationEngine::timerCallback() {
+    if (!workPending.exchange(false, std::memory_order_acquire)) return;
+
+    std::lock_guard<std::mutex> lock{allocationMutex};
+    delete retired.exchange(nullptr);
+
+    BusSettings wanted {
+        .sampleRate = allocated.sampleRate, // the size doesn't depend on it
+        .bufferSize = requestedBufferSize.load(),
+        .channels = requestedChannels.load(),
+    };
+    if (allocated.channels >= wanted.channels && allocated.bufferSize >= wanted.bufferSize)
+        return; // already swapped in or waiting to be
+
+    auto* fresh = new ScratchMemory();
+    fresh->Allocate(wanted, oversamplingFactor);
+    allocated = wanted;
+
+    // a pending one the audio thread didn't take yet is too small now
+    delete incoming.exchange(fresh);
+}
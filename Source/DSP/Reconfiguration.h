@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    Keeps bus setting changes (channels, block size, sample rate) off the
+    allocator while the audio thread is running.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_events/juce_events.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+//==============================================================================
+
+struct BusSettings {
+    size_t sampleRate = 48000;
+    size_t bufferSize = 512;
+    size_t channels = 2;
+};
+
+// All scratch memory the DSP needs, sized once for a maximum.
+struct ScratchMemory {
+    BusSettings capacity{}; // at the host rate. Its sampleRate doesn't change the size, so Fits ignores it.
+    size_t oversamplingFactor = 1;
+    // capacity.bufferSize * oversamplingFactor samples, so it fits a block at the processing rate
+    juce::AudioBuffer<float> floatBuffer{};
+    juce::AudioBuffer<double> doubleBuffer{};
+
+    // allocates, never call this on the audio thread
+    void Allocate(BusSettings maximum, size_t newOversamplingFactor);
+    bool Fits(const BusSettings& settings) const;
+
+    template <typename FloatType>
+    juce::AudioBuffer<FloatType>& Get() {
+        if constexpr (std::is_same_v<FloatType, float>) return floatBuffer;
+        else return doubleBuffer;
+    }
+};
+
+// prepareToPlay sizes the scratch memory for the declared maximum, so changes within it are absorbed without allocating.
+// Changes that don't fit keep running on the old memory (processing at most its capacity) while bigger memory
+// is allocated on the message thread, and it's swapped in at the start of a later block.
+// The audio thread only raises a flag for that, which a timer polls: triggerAsyncUpdate posts a message, and that can lock and allocate.
+class ReconfigurationEngine : private juce::Timer {
+public:
+    static constexpr int pollRateHz = 50;
+
+    // message thread. Without a message manager nothing polls, and changes that don't fit stay capped at the prepared capacity.
+    ReconfigurationEngine();
+    ~ReconfigurationEngine() override;
+
+    // call from prepareToPlay, audio isn't running then so it allocates right away.
+    // The scratch memory holds oversamplingFactor times the block size, later allocations keep that factor.
+    void Prepare(BusSettings settings, BusSettings maximum, size_t oversamplingFactor = 1);
+
+    // audio thread, at the start of every block. Never allocates.
+    // @return true if the settings changed. Shorter blocks than the prepared size don't count as a change.
+    bool Update(const BusSettings& settings);
+
+    // audio thread only
+    ScratchMemory& GetScratch() { return *active; }
+    const BusSettings& GetSettings() const { return current; }
+
+private:
+    // message thread, frees retired memory and allocates what was asked for
+    void timerCallback() override;
+
+    BusSettings current{};
+    std::unique_ptr<ScratchMemory> active = std::make_unique<ScratchMemory>(); // owned by the audio thread
+    std::atomic<ScratchMemory*> incoming {nullptr}; // allocated on the message thread, waiting to be swapped in
+    std::atomic<ScratchMemory*> retired {nullptr};  // swapped out, deleted on the message thread
+
+    std::mutex allocationMutex; // never taken on the audio thread
+    BusSettings allocated{};    // capacity of the newest allocation, guarded by allocationMutex
+    size_t oversamplingFactor = 1; // guarded by allocationMutex
+
+    // the capacity the audio thread asked for, with workPending raised after them
+    std::atomic<size_t> requestedBufferSize {0};
+    std::atomic<size_t> requestedChannels {0};
+    std::atomic<bool> workPending {false};
+};
@@ -0,0 +1,9 @@
+#include "SilenceDetector.h"
+
+//==============================================================================
+
+void SilenceDetector::Prepare(int tailSamples, float thresholdDecibels) {
+    tail = std::max(tailSamples, 0);
+    threshold = juce::Decibels::decibelsToGain(thresholdDecibels);
+    silentSamples = 0; // assume there was sound, so nothing gets cut off
+}
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    Lets the DSP sleep on silent input. Once the input has been silent for
+    longer than the tail, the output can't be anything but silence either.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <juce_audio_basics/juce_audio_basics.h>
+
+//==============================================================================
+
+class SilenceDetector {
+public:
+    // tailSamples is how long the output can keep going after the input stops (DSP tail + latency)
+    void Prepare(int tailSamples, float thresholdDecibels = -120.f);
+
+    // audio thread, on the input before processing. Any input above the threshold wakes it up right away.
+    // @return true if the input was silent for at least the tail before this block, so the whole block's output is silent
+    template <typename FloatType>
+    bool CanSleep(const juce::AudioBuffer<FloatType>& buffer, int numInputChannels);
+    // audio thread, for blocks where the DSP can't sleep anyway (bypassed, MIDI). It has to see the whole tail of silence again after them.
+    void Reset() { silentSamples = 0; }
+
+private:
+    template <typename FloatType>
+    bool IsSilent(const juce::AudioBuffer<FloatType>& buffer, int numInputChannels) const;
+
+    juce::int64 silentSamples = 0; // how long the input has been silent for
+    juce::int64 tail = 0;
+    float threshold = 0.f;
+};
+
+//==============================================================================
+
+template <typename FloatType>
+bool SilenceDetector::IsSilent(const juce::AudioBuffer<FloatType>& buffer, int numInputChannels) const {
+    const auto limit = static_cast<FloatType>(threshold);
+    const int channels = std::min(numInputChannels, buffer.getNumChannels());
+
+    for (int channel = 0; channel < channels; ++channel) {
+        // vectorized, and done after the first loud channel
+        auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(channel), buffer.getNumSamples());
+        if (range.getEnd() > limit || range.getStart() < -limit) return false;
+    }
+    return true;
+}
+
+template <typename FloatType>
+bool SilenceDetector::CanSleep(const juce::AudioBuffer<FloatType>& buffer, int numInputChannels) {
+    if (!IsSilent(buffer, numInputChannels)) {
+        silentSamples = 0;
+        return false;
+    }
+
+    const bool tailDecayed = silentSamples >= tail;
+    silentSamples += buffer.getNumSamples();
+    return tailDecayed;
+}
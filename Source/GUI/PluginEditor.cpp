@@ -19,6 +19,7 @@ MyPluginEditor::MyPluginEditor(MyPluginProcessor &p)
     setResizeLimits(400, 250, 1500, 1000);
 
     // make your components visible as well.
+    addAndMakeVisible(loadOverlay);
 }
 
 MyPluginEditor::~MyPluginEditor()
@@ -40,4 +41,5 @@ void MyPluginEditor::paint(juce::Graphics &g)
 void MyPluginEditor::resized()
 {
     auto bounds = getLocalBounds();
+    loadOverlay.setBounds(bounds.removeFromTop(70).removeFromRight(220).reduced(6));
 }
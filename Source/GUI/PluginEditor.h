@@ -10,6 +10,7 @@
 
 #include "DSP/PluginProcessor.h"
 #include <juce_audio_processors/juce_audio_processors.h>
+#include "subnite_extras/gui/load_meter_overlay.hpp"
 
 //==============================================================================
 /**
@@ -30,5 +31,7 @@ private:
     // access the processor object that created it.
     MyPluginProcessor& audioProcessor;
 
+    subnite::LoadMeterOverlay loadOverlay{audioProcessor.loadMeter}; // live CPU load of this instance
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MyPluginEditor)
 };